@@ -0,0 +1,313 @@
+#ifndef _BENCHMARK_H
+#define _BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A small benchmark harness in the style of Google Benchmark (with the same command line flags and JSON layout,
+// so its compare.py can diff two runs), without the dependency.
+//
+// A benchmark is a function taking a BenchmarkState, which repeats the measured code while keepRunning() says so:
+//
+//     void multiply(BenchmarkState& state)
+//     {
+//         Polynomial<double> a = ..., b = ...;     // setup, not measured
+//         while (state.keepRunning())
+//             do_not_optimise(a * b);
+//     }
+//
+// It is registered with the arguments (e.g. degrees) to run it with, and the runner repeats every
+// (benchmark, argument) pair with a growing number of iterations until it runs for long enough.
+
+// Keep the compiler from optimising away a result which is never used
+template<typename T>
+void do_not_optimise(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+class BenchmarkState
+{
+    public:
+        BenchmarkState(const size_t argument, const size_t iterations);
+
+        // The argument of this run (the degree of the polynomials, for example)
+        size_t argument() const;
+
+        // Whether the measured code should run once more
+        bool keepRunning();
+
+        // The number of items processed in all the iterations (for the items per second rate)
+        void setItemsProcessed(const size_t items);
+        size_t itemsProcessed() const;
+
+    private:
+        size_t m_argument;
+        size_t m_iterations;
+        size_t m_remaining;
+        size_t m_items;
+};
+
+typedef std::function<void(BenchmarkState&)> BenchmarkFunction;
+
+struct BenchmarkResult
+{
+    std::string name;
+    size_t iterations;
+
+    // Per iteration, in nanoseconds
+    double realTime;
+    double cpuTime;
+
+    // Zero if the benchmark didn't set the number of items
+    double itemsPerSecond;
+};
+
+class BenchmarkRunner
+{
+    public:
+        BenchmarkRunner();
+
+        // Register a benchmark to run with each of the arguments (its name becomes name/argument)
+        void add(const std::string& name, const BenchmarkFunction& function, const std::vector<size_t>& arguments);
+
+        // Parse the command line and run the benchmarks, returns the exit code of the program. The flags:
+        //     --benchmark_filter=<regex>          run only the benchmarks whose name matches
+        //     --benchmark_min_time=<seconds>      the minimal time of a measurement (0.5 by default)
+        //     --benchmark_format=<console|json>   the format of the standard output
+        //     --benchmark_out=<file>              also write the results into the file, as JSON
+        //     --benchmark_list_tests              only list the names
+        int run(int argc, char** argv);
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            BenchmarkFunction function;
+            size_t argument;
+        };
+
+        std::vector<Entry> m_entries;
+        double m_minTime;
+
+        BenchmarkResult _measure(const Entry& entry) const;
+        static void _printConsole(std::ostream& o, const BenchmarkResult& result);
+        static void _printJson(std::ostream& o, const std::string& executable, const std::vector<BenchmarkResult>& results);
+};
+
+BenchmarkState::BenchmarkState(const size_t argument, const size_t iterations)
+{
+    this->m_argument = argument;
+    this->m_iterations = iterations;
+    this->m_remaining = iterations;
+    this->m_items = 0;
+}
+
+size_t BenchmarkState::argument() const
+{
+    return this->m_argument;
+}
+
+bool BenchmarkState::keepRunning()
+{
+    if (this->m_remaining == 0)
+        return false;
+
+    --this->m_remaining;
+    return true;
+}
+
+void BenchmarkState::setItemsProcessed(const size_t items)
+{
+    this->m_items = items;
+}
+
+size_t BenchmarkState::itemsProcessed() const
+{
+    return this->m_items;
+}
+
+BenchmarkRunner::BenchmarkRunner()
+{
+    this->m_minTime = 0.5;
+}
+
+void BenchmarkRunner::add(const std::string& name, const BenchmarkFunction& function, const std::vector<size_t>& arguments)
+{
+    for (size_t i = 0; i < arguments.size(); ++i)
+    {
+        std::ostringstream full;
+        full << name << "/" << arguments[i];
+
+        Entry entry = { full.str(), function, arguments[i] };
+        this->m_entries.push_back(entry);
+    }
+}
+
+int BenchmarkRunner::run(int argc, char** argv)
+{
+    std::string filter = ".*", format = "console", out;
+    bool list = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string flag = argv[i];
+        const size_t equals = flag.find('=');
+        const std::string key = flag.substr(0, equals), value = (equals == std::string::npos ? "" : flag.substr(equals + 1));
+
+        if (key == "--benchmark_filter")
+            filter = value;
+        else if (key == "--benchmark_min_time")
+            this->m_minTime = std::atof(value.c_str());
+        else if (key == "--benchmark_format" && (value == "console" || value == "json"))
+            format = value;
+        else if (key == "--benchmark_out")
+            out = value;
+        else if (key == "--benchmark_list_tests")
+            list = true;
+        else
+        {
+            std::cerr << "Unknown flag: " << flag << std::endl;
+            return 1;
+        }
+    }
+
+    const std::regex pattern(filter);
+    std::vector<BenchmarkResult> results;
+    for (size_t i = 0; i < this->m_entries.size(); ++i)
+    {
+        const Entry& entry = this->m_entries[i];
+        if (!std::regex_search(entry.name, pattern))
+            continue;
+
+        if (list)
+        {
+            std::cout << entry.name << std::endl;
+            continue;
+        }
+
+        results.push_back(this->_measure(entry));
+        if (format == "console")
+            _printConsole(std::cout, results.back());
+    }
+
+    if (!list && format == "json")
+        _printJson(std::cout, argv[0], results);
+
+    if (!list && !out.empty())
+    {
+        std::ofstream file(out.c_str());
+        if (!file)
+        {
+            std::cerr << "Can't write " << out << std::endl;
+            return 1;
+        }
+        _printJson(file, argv[0], results);
+    }
+
+    return 0;
+}
+
+BenchmarkResult BenchmarkRunner::_measure(const Entry& entry) const
+{
+    // Grow the number of iterations (by 10x at most, aiming a bit above the minimal time) until a run is long enough
+    size_t iterations = 1;
+    while (true)
+    {
+        BenchmarkState state(entry.argument, iterations);
+
+        const std::clock_t cpuStart = std::clock();
+        const std::chrono::steady_clock::time_point realStart = std::chrono::steady_clock::now();
+        entry.function(state);
+        const double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+        const double cpu = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        if (real >= this->m_minTime || iterations >= 1000000000)
+        {
+            BenchmarkResult result;
+            result.name = entry.name;
+            result.iterations = iterations;
+            result.realTime = real * 1e9 / iterations;
+            result.cpuTime = cpu * 1e9 / iterations;
+            result.itemsPerSecond = (state.itemsProcessed() > 0 && real > 0 ? state.itemsProcessed() / real : 0);
+            return result;
+        }
+
+        const double factor = (real > 0 ? 1.4 * this->m_minTime / real : 10);
+        iterations = std::max(iterations + 1, static_cast<size_t>(iterations * std::min(factor, 10.0)));
+    }
+}
+
+void BenchmarkRunner::_printConsole(std::ostream& o, const BenchmarkResult& result)
+{
+    o << std::left << std::setw(48) << result.name << std::right
+        << std::fixed << std::setprecision(0)
+        << std::setw(14) << result.realTime << " ns"
+        << std::setw(14) << result.cpuTime << " ns"
+        << std::setw(12) << result.iterations;
+    if (result.itemsPerSecond > 0)
+        o << std::setprecision(3) << std::scientific << "  " << result.itemsPerSecond << " items/s";
+    o << std::defaultfloat << std::endl;
+}
+
+void BenchmarkRunner::_printJson(std::ostream& o, const std::string& executable, const std::vector<BenchmarkResult>& results)
+{
+    char date[64];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    o << "{" << std::endl;
+    o << "  \"context\": {" << std::endl;
+    o << "    \"date\": \"" << date << "\"," << std::endl;
+    o << "    \"executable\": \"" << executable << "\"," << std::endl;
+    o << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "," << std::endl;
+#if defined(__VERSION__)
+    o << "    \"compiler\": \"" << __VERSION__ << "\"," << std::endl;
+#endif
+#if defined(NDEBUG)
+    o << "    \"library_build_type\": \"release\"" << std::endl;
+#else
+    o << "    \"library_build_type\": \"debug\"" << std::endl;
+#endif
+    o << "  }," << std::endl;
+    o << "  \"benchmarks\": [" << std::endl;
+
+    o << std::setprecision(10);
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        o << "    {" << std::endl;
+        o << "      \"name\": \"" << result.name << "\"," << std::endl;
+        o << "      \"run_name\": \"" << result.name << "\"," << std::endl;
+        o << "      \"run_type\": \"iteration\"," << std::endl;
+        o << "      \"iterations\": " << result.iterations << "," << std::endl;
+        o << "      \"real_time\": " << result.realTime << "," << std::endl;
+        o << "      \"cpu_time\": " << result.cpuTime << "," << std::endl;
+        if (result.itemsPerSecond > 0)
+            o << "      \"items_per_second\": " << result.itemsPerSecond << "," << std::endl;
+        o << "      \"time_unit\": \"ns\"" << std::endl;
+        o << "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+
+    o << "  ]" << std::endl;
+    o << "}" << std::endl;
+}
+
+#endif // _BENCHMARK_H
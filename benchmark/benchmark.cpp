@@ -0,0 +1,530 @@
+/*
+* Benchmarks of the library, see Benchmark.hpp for the flags.
+* Build it with optimisations against the C++11 standard, e.g.
+*     g++ -std=c++11 -O2 -DNDEBUG -pthread -Isrc benchmark/benchmark.cpp -o polynom_benchmark
+*/
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "Benchmark.hpp"
+#include "Polynomial.hpp"
+#include "Complex.hpp"
+#include "EuclideanAlgorithm.hpp"
+#include "LagrangeInterpolation.hpp"
+#include "ParallelMultiplication.hpp"
+#include "PolynomialBatch.hpp"
+#include "PolynomialGcd.hpp"
+#include "Rational.hpp"
+#include "Residue.hpp"
+#include "Serialisation.hpp"
+#include "SimdKernels.hpp"
+#include "SmallPolynomial.hpp"
+#include "SplitComplexPolynomial.hpp"
+
+typedef ResidueNum<998244353> Residue998;
+
+// Random coefficients: small integers for Rational (so the products don't overflow), anything for the others
+double random_coefficient(std::mt19937_64& random, double*)
+{
+    return std::uniform_real_distribution<double>(-1000, 1000)(random);
+}
+
+float random_coefficient(std::mt19937_64& random, float*)
+{
+    return std::uniform_real_distribution<float>(-1000, 1000)(random);
+}
+
+Rational random_coefficient(std::mt19937_64& random, Rational*)
+{
+    return Rational(static_cast<long long>(random() % 19) - 9);
+}
+
+Residue998 random_coefficient(std::mt19937_64& random, Residue998*)
+{
+    return Residue998(static_cast<long>(random() % 998244353));
+}
+
+Complex random_coefficient(std::mt19937_64& random, Complex*)
+{
+    return Complex(random_coefficient(random, static_cast<double*>(nullptr)), random_coefficient(random, static_cast<double*>(nullptr)));
+}
+
+template<typename T>
+T random_coefficient(std::mt19937_64& random)
+{
+    return random_coefficient(random, static_cast<T*>(nullptr));
+}
+
+// A random polynomial of the given degree (with non-zero leading coefficient)
+template<typename T>
+Polynomial<T> random_polynomial(std::mt19937_64& random, const size_t degree)
+{
+    std::vector<T> coefficients(degree + 1);
+    for (size_t i = 0; i <= degree; ++i)
+        coefficients[i] = random_coefficient<T>(random);
+    if (coefficients[degree] == id_additive<T>::value)
+        coefficients[degree] = id_multiplicative<T>::value;
+    return Polynomial<T>(coefficients.cbegin(), coefficients.cend());
+}
+
+/* Polynomial operations, the argument is the degree */
+template<typename T>
+void benchmark_add(BenchmarkState& state)
+{
+    std::mt19937_64 random(1);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+    const Polynomial<T> b = random_polynomial<T>(random, state.argument());
+
+    while (state.keepRunning())
+    {
+        Polynomial<T> sum = a + b;
+        do_not_optimise(sum);
+    }
+}
+
+template<typename T>
+void benchmark_multiply(BenchmarkState& state)
+{
+    std::mt19937_64 random(2);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+    const Polynomial<T> b = random_polynomial<T>(random, state.argument());
+
+    while (state.keepRunning())
+    {
+        Polynomial<T> product = a * b;
+        do_not_optimise(product);
+    }
+}
+
+// The same on the shared thread pool
+template<typename T>
+void benchmark_parallel_multiply(BenchmarkState& state)
+{
+    std::mt19937_64 random(2);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+    const Polynomial<T> b = random_polynomial<T>(random, state.argument());
+
+    while (state.keepRunning())
+    {
+        Polynomial<T> product = parallel_multiply(a, b);
+        do_not_optimise(product);
+    }
+}
+
+template<typename T>
+void benchmark_divide(BenchmarkState& state)
+{
+    // A 2n degree polynomial divided by a monic n degree one. The dividend is made of a random quotient and
+    // remainder, so the division is exact and the Rational coefficients stay small all along.
+    std::mt19937_64 random(3);
+    const size_t n = state.argument();
+    Polynomial<T> b = random_polynomial<T>(random, n);
+    b.setMember(n, id_multiplicative<T>::value);
+    const Polynomial<T> a = b * random_polynomial<T>(random, n) + random_polynomial<T>(random, n - 1);
+
+    Polynomial<T> quotient, remainder;
+    while (state.keepRunning())
+    {
+        a.divide(b, quotient, remainder);
+        do_not_optimise(quotient);
+        do_not_optimise(remainder);
+    }
+}
+
+template<typename T>
+void benchmark_at(BenchmarkState& state)
+{
+    std::mt19937_64 random(4);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+    const T t = random_coefficient<T>(random);
+
+    while (state.keepRunning())
+        do_not_optimise(a.at(t));
+}
+
+template<typename T>
+void benchmark_derive(BenchmarkState& state)
+{
+    std::mt19937_64 random(5);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+
+    while (state.keepRunning())
+    {
+        Polynomial<T> derivative = a.derive();
+        do_not_optimise(derivative);
+    }
+}
+
+template<typename T>
+void benchmark_gcd(BenchmarkState& state)
+{
+    std::mt19937_64 random(6);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+    const Polynomial<T> b = random_polynomial<T>(random, state.argument());
+
+    while (state.keepRunning())
+    {
+        Polynomial<T> gcd = polynomial_gcd(a, b);
+        do_not_optimise(gcd);
+    }
+}
+
+/* The Euclidean algorithm on consecutive Fibonacci numbers (the worst case), the argument is the index */
+void benchmark_euclidean_fibonacci(BenchmarkState& state)
+{
+    long long a = 1, b = 1;
+    for (size_t i = 2; i < state.argument(); ++i)
+    {
+        const long long c = a + b;
+        a = b;
+        b = c;
+    }
+
+    while (state.keepRunning())
+        do_not_optimise(euclidean<long long>(b, a));
+}
+
+void benchmark_extended_euclidean_fibonacci(BenchmarkState& state)
+{
+    long long a = 1, b = 1;
+    for (size_t i = 2; i < state.argument(); ++i)
+    {
+        const long long c = a + b;
+        a = b;
+        b = c;
+    }
+
+    while (state.keepRunning())
+        do_not_optimise(extended_euclidean<long long>(b, a));
+}
+
+/* Arithmetic of the coefficient types on arrays, the argument is the length */
+template<typename T>
+void benchmark_coefficient_arithmetic(BenchmarkState& state)
+{
+    std::mt19937_64 random(7);
+    std::vector<T> a(state.argument()), b(state.argument());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = random_coefficient<T>(random);
+        do
+            b[i] = random_coefficient<T>(random);
+        while (b[i] == id_additive<T>::value);
+    }
+
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        // One of each operation per element
+        for (size_t i = 0; i < a.size(); ++i)
+            do_not_optimise((a[i] + b[i]) * b[i] - a[i] / b[i]);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * a.size());
+}
+
+// Rationals with small numerators and denominators
+void benchmark_rational_arithmetic(BenchmarkState& state)
+{
+    std::mt19937_64 random(8);
+    std::vector<Rational> a(state.argument()), b(state.argument());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = Rational(static_cast<long long>(random() % 2001) - 1000, 1 + random() % 1000);
+        b[i] = Rational(1 + static_cast<long long>(random() % 1000), 1 + random() % 1000);
+    }
+
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        for (size_t i = 0; i < a.size(); ++i)
+            do_not_optimise((a[i] + b[i]) * b[i] - a[i] / b[i]);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * a.size());
+}
+
+/* Lagrange interpolation through the given number of points */
+template<typename T>
+void benchmark_lagrange_build(BenchmarkState& state)
+{
+    std::mt19937_64 random(9);
+    Lagrange<T> lagrange;
+    for (size_t i = 0; i < state.argument(); ++i)
+        lagrange.add(T(static_cast<long>(i)), random_coefficient<T>(random));
+
+    while (state.keepRunning())
+    {
+        Lagrange<T> copy = lagrange;
+        copy.build();
+        do_not_optimise(copy);
+    }
+}
+
+/* Polynomials with inline storage, the argument is their degree N (a template argument too) */
+template<typename T, size_t N>
+void benchmark_small_multiply(BenchmarkState& state)
+{
+    std::mt19937_64 random(13);
+    const SmallPolynomial<T, N> a(random_polynomial<T>(random, N));
+    const SmallPolynomial<T, N> b(random_polynomial<T>(random, N));
+
+    while (state.keepRunning())
+    {
+        SmallPolynomial<T, 2 * N> product = a * b;
+        do_not_optimise(product);
+    }
+}
+
+/* Batches of small polynomials, the argument is the number of polynomials */
+template<typename T>
+PolynomialBatch<T> random_batch(std::mt19937_64& random, const size_t count, const size_t degree)
+{
+    PolynomialBatch<T> batch(count, degree);
+    for (size_t k = 0; k < count; ++k)
+        batch.setPolynomial(k, random_polynomial<T>(random, degree));
+    return batch;
+}
+
+template<typename T>
+void benchmark_batch_multiply(BenchmarkState& state)
+{
+    std::mt19937_64 random(10);
+    const PolynomialBatch<T> a = random_batch<T>(random, state.argument(), 16);
+    const PolynomialBatch<T> b = random_batch<T>(random, state.argument(), 16);
+
+    PolynomialBatch<T> product;
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        batch_multiply(a, b, product);
+        do_not_optimise(product);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * state.argument());
+}
+
+// Degree 32 polynomials divided by degree 16 ones
+template<typename T>
+void benchmark_batch_divide(BenchmarkState& state)
+{
+    std::mt19937_64 random(11);
+    const PolynomialBatch<T> a = random_batch<T>(random, state.argument(), 32);
+    const PolynomialBatch<T> b = random_batch<T>(random, state.argument(), 16);
+
+    PolynomialBatch<T> quotient, remainder;
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        batch_divide(a, b, quotient, remainder);
+        do_not_optimise(quotient);
+        do_not_optimise(remainder);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * state.argument());
+}
+
+template<typename T>
+void benchmark_batch_evaluate(BenchmarkState& state)
+{
+    std::mt19937_64 random(12);
+    const PolynomialBatch<T> a = random_batch<T>(random, state.argument(), 16);
+    std::vector<T> points(state.argument()), values;
+    for (size_t k = 0; k < points.size(); ++k)
+        points[k] = random_coefficient<T>(random);
+
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        batch_evaluate(a, points, values);
+        do_not_optimise(values);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * state.argument());
+}
+
+/* Binary serialisation, the argument is the degree */
+template<typename T>
+void benchmark_serialise(BenchmarkState& state)
+{
+    std::mt19937_64 random(17);
+    const Polynomial<T> a = random_polynomial<T>(random, state.argument());
+    std::stringstream stream;
+
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        stream.seekp(0);
+        PolynomialWriter writer(stream);
+        writer.write(a);
+        writer.flush();
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * (state.argument() + 1));
+}
+
+template<typename T>
+void benchmark_deserialise(BenchmarkState& state)
+{
+    std::mt19937_64 random(18);
+    std::stringstream stream;
+    {
+        PolynomialWriter writer(stream);
+        writer.write(random_polynomial<T>(random, state.argument()));
+    }
+
+    Polynomial<T> b;
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        stream.clear();
+        stream.seekg(0);
+        PolynomialReader reader(stream);
+        reader.read(b);
+        do_not_optimise(b);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * (state.argument() + 1));
+}
+
+/* Complex polynomials with split storage, the argument is the degree */
+template<typename R>
+void benchmark_split_complex_multiply(BenchmarkState& state)
+{
+    std::mt19937_64 random(15);
+    const SplitComplexPolynomial<R> a(random_polynomial<Complex>(random, state.argument()));
+    const SplitComplexPolynomial<R> b(random_polynomial<Complex>(random, state.argument()));
+
+    while (state.keepRunning())
+    {
+        SplitComplexPolynomial<R> product = a * b;
+        do_not_optimise(product);
+    }
+}
+
+template<typename R>
+void benchmark_split_complex_evaluate(BenchmarkState& state)
+{
+    std::mt19937_64 random(16);
+    const SplitComplexPolynomial<R> a(random_polynomial<Complex>(random, 32));
+    std::vector<R> pointsReal(state.argument()), pointsImag(state.argument()), valuesReal, valuesImag;
+    for (size_t k = 0; k < pointsReal.size(); ++k)
+    {
+        pointsReal[k] = std::uniform_real_distribution<R>(-1, 1)(random);
+        pointsImag[k] = std::uniform_real_distribution<R>(-1, 1)(random);
+    }
+
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        a.evaluate(pointsReal, pointsImag, valuesReal, valuesImag);
+        do_not_optimise(valuesReal);
+        ++iterations;
+    }
+    state.setItemsProcessed(iterations * state.argument());
+}
+
+/* The coefficient kernels on their own, the argument is the length of the arrays (set_simd_level() clamps the
+   level, so SIMD_AVX512 is the best one the processor has) */
+template<typename T, SimdLevel Level>
+void benchmark_simd_multiply_add(BenchmarkState& state)
+{
+    std::mt19937_64 random(14);
+    std::vector<T> a(state.argument()), result(state.argument());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = random_coefficient<T>(random);
+        result[i] = random_coefficient<T>(random);
+    }
+    const T c = random_coefficient<T>(random);
+
+    const SimdLevel previous = simd_level();
+    set_simd_level(Level);
+    size_t iterations = 0;
+    while (state.keepRunning())
+    {
+        simd_multiply_add(a.data(), c, result.data(), a.size());
+        do_not_optimise(result);
+        ++iterations;
+    }
+    set_simd_level(previous);
+    state.setItemsProcessed(iterations * state.argument());
+}
+
+int main(int argc, char** argv)
+{
+    const std::vector<size_t> degrees = { 8, 32, 128, 512, 2048 };
+    const std::vector<size_t> small = { 8, 32, 128 };
+
+    BenchmarkRunner runner;
+
+    runner.add("polynomial_add<double>", benchmark_add<double>, degrees);
+    runner.add("polynomial_add<Rational>", benchmark_add<Rational>, small);
+    runner.add("polynomial_add<ResidueNum>", benchmark_add<Residue998>, degrees);
+    runner.add("polynomial_add<Complex>", benchmark_add<Complex>, small);
+
+    runner.add("polynomial_multiply<double>", benchmark_multiply<double>, degrees);
+    runner.add("polynomial_multiply<Rational>", benchmark_multiply<Rational>, small);
+    runner.add("polynomial_multiply<ResidueNum>", benchmark_multiply<Residue998>, degrees);
+    runner.add("polynomial_multiply<Complex>", benchmark_multiply<Complex>, small);
+    runner.add("split_complex_multiply<double>", benchmark_split_complex_multiply<double>, degrees);
+    runner.add("split_complex_multiply<long double>", benchmark_split_complex_multiply<long double>, small);
+
+    runner.add("polynomial_parallel_multiply<double>", benchmark_parallel_multiply<double>, { 2048, 8192, 32768 });
+    runner.add("polynomial_parallel_multiply<ResidueNum>", benchmark_parallel_multiply<Residue998>, { 2048, 8192, 32768 });
+
+    runner.add("polynomial_divide<double>", benchmark_divide<double>, degrees);
+    runner.add("polynomial_divide<Rational>", benchmark_divide<Rational>, { 8, 32 });
+    runner.add("polynomial_divide<ResidueNum>", benchmark_divide<Residue998>, degrees);
+
+    runner.add("polynomial_at<double>", benchmark_at<double>, degrees);
+    runner.add("polynomial_at<Rational>", benchmark_at<Rational>, { 8 });
+    runner.add("polynomial_at<ResidueNum>", benchmark_at<Residue998>, degrees);
+
+    runner.add("polynomial_derive<double>", benchmark_derive<double>, degrees);
+    runner.add("polynomial_derive<Rational>", benchmark_derive<Rational>, small);
+    runner.add("polynomial_derive<ResidueNum>", benchmark_derive<Residue998>, degrees);
+
+    runner.add("polynomial_gcd<ResidueNum>", benchmark_gcd<Residue998>, degrees);
+
+    runner.add("euclidean<long long>", benchmark_euclidean_fibonacci, { 10, 40, 90 });
+    runner.add("extended_euclidean<long long>", benchmark_extended_euclidean_fibonacci, { 10, 40, 90 });
+
+    runner.add("arithmetic<Rational>", benchmark_rational_arithmetic, { 1024 });
+    runner.add("arithmetic<ResidueNum>", benchmark_coefficient_arithmetic<Residue998>, { 1024 });
+    runner.add("arithmetic<double>", benchmark_coefficient_arithmetic<double>, { 1024 });
+
+    runner.add("lagrange_build<ResidueNum>", benchmark_lagrange_build<Residue998>, { 8, 32, 128 });
+    runner.add("lagrange_build<double>", benchmark_lagrange_build<double>, { 8, 32, 128 });
+
+    runner.add("serialise<ResidueNum>", benchmark_serialise<Residue998>, degrees);
+    runner.add("serialise<double>", benchmark_serialise<double>, degrees);
+    runner.add("serialise<Rational>", benchmark_serialise<Rational>, small);
+    runner.add("deserialise<ResidueNum>", benchmark_deserialise<Residue998>, degrees);
+    runner.add("deserialise<double>", benchmark_deserialise<double>, degrees);
+    runner.add("deserialise<Rational>", benchmark_deserialise<Rational>, small);
+
+    runner.add("small_multiply<double>", benchmark_small_multiply<double, 8>, { 8 });
+    runner.add("small_multiply<double>", benchmark_small_multiply<double, 16>, { 16 });
+    runner.add("small_multiply<ResidueNum>", benchmark_small_multiply<Residue998, 8>, { 8 });
+    runner.add("small_multiply<ResidueNum>", benchmark_small_multiply<Residue998, 16>, { 16 });
+
+    runner.add("batch_multiply<double>", benchmark_batch_multiply<double>, { 4096 });
+    runner.add("batch_multiply<float>", benchmark_batch_multiply<float>, { 4096 });
+    runner.add("batch_multiply<ResidueNum>", benchmark_batch_multiply<Residue998>, { 4096 });
+    runner.add("batch_divide<double>", benchmark_batch_divide<double>, { 4096 });
+    runner.add("batch_divide<float>", benchmark_batch_divide<float>, { 4096 });
+    runner.add("batch_divide<ResidueNum>", benchmark_batch_divide<Residue998>, { 4096 });
+    runner.add("batch_evaluate<double>", benchmark_batch_evaluate<double>, { 4096 });
+    runner.add("batch_evaluate<float>", benchmark_batch_evaluate<float>, { 4096 });
+    runner.add("batch_evaluate<ResidueNum>", benchmark_batch_evaluate<Residue998>, { 4096 });
+    runner.add("split_complex_evaluate<double>", benchmark_split_complex_evaluate<double>, { 4096 });
+
+    runner.add("simd_multiply_add<double>/scalar", benchmark_simd_multiply_add<double, SIMD_SCALAR>, { 4096 });
+    runner.add("simd_multiply_add<double>", benchmark_simd_multiply_add<double, SIMD_AVX512>, { 4096 });
+    runner.add("simd_multiply_add<ResidueNum>/scalar", benchmark_simd_multiply_add<Residue998, SIMD_SCALAR>, { 4096 });
+    runner.add("simd_multiply_add<ResidueNum>", benchmark_simd_multiply_add<Residue998, SIMD_AVX512>, { 4096 });
+
+    return runner.run(argc, argv);
+}
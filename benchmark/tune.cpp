@@ -0,0 +1,363 @@
+/*
+* Measures the crossover lengths of the algorithms on this machine, for every coefficient type, and writes them
+* as a header of algorithm_thresholds<T> specialisations (see Thresholds.hpp):
+*     polynom_tune [output file, TunedThresholds.hpp by default]
+* Build it with the same optimisations as the programs which will use the thresholds.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "Polynomial.hpp"
+#include "Complex.hpp"
+#include "DenseMultiplication.hpp"
+#include "PolynomialGcd.hpp"
+#include "Rational.hpp"
+#include "Residue.hpp"
+
+// The modulus the ResidueNum<M> thresholds are measured with
+const long TUNED_MODULUS = 998244353;
+typedef ResidueNum<TUNED_MODULUS> Residue998;
+
+template<typename T>
+struct threshold_tuning
+{
+    static void divide(Polynomial<T> dividend, const Polynomial<T>& divisor, const size_t denseDivision)
+    {
+        Polynomial<T> quotient;
+        Polynomial<T>::_longDivision(dividend, divisor, quotient, denseDivision);
+    }
+};
+
+// Random coefficients: small integers for Rational, so the calculations don't overflow
+double random_coefficient(std::mt19937_64& random, double*)
+{
+    return std::uniform_real_distribution<double>(-1000, 1000)(random);
+}
+
+Rational random_coefficient(std::mt19937_64& random, Rational*)
+{
+    return Rational(static_cast<long long>(random() % 7) - 3);
+}
+
+Residue998 random_coefficient(std::mt19937_64& random, Residue998*)
+{
+    return Residue998(static_cast<long>(random() % TUNED_MODULUS));
+}
+
+Complex random_coefficient(std::mt19937_64& random, Complex*)
+{
+    return Complex(random_coefficient(random, static_cast<double*>(nullptr)), random_coefficient(random, static_cast<double*>(nullptr)));
+}
+
+template<typename T>
+CoefficientBuffer<T> random_buffer(std::mt19937_64& random, const size_t length)
+{
+    CoefficientBuffer<T> buffer(length);
+    for (size_t i = 0; i < length; ++i)
+        buffer[i] = random_coefficient(random, static_cast<T*>(nullptr));
+    if (length > 0)
+        buffer.back() = id_multiplicative<T>::value; // Monic, so the divisions are exact for Rational too
+    return buffer;
+}
+
+// The time of a single run of the function: as many calls as fit into a window long enough for the timer,
+// in seconds per call
+double measure(const std::function<void()>& function)
+{
+    size_t calls = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double elapsed = 0;
+    do
+    {
+        function();
+        ++calls;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    while (elapsed < 0.02);
+
+    return elapsed / calls;
+}
+
+// The time of the fast method relative to the slow one: the median of the ratios of a few runs of both, taken
+// in turns. (So a slowdown of the machine hits both of a pair, and the median doesn't care about the odd
+// disturbed pair; the fastest of separate short runs moved the crossovers by a factor of two or more from one
+// tuning to the next.)
+double relative_time(const std::function<void()>& fast, const std::function<void()>& slow)
+{
+    const int runs = 9;
+    std::vector<double> ratios;
+    for (int run = 0; run < runs; ++run)
+    {
+        double fastTime, slowTime;
+        if (run % 2 == 0)
+        {
+            fastTime = measure(fast);
+            slowTime = measure(slow);
+        }
+        else
+        {
+            slowTime = measure(slow);
+            fastTime = measure(fast);
+        }
+        ratios.push_back(fastTime / slowTime);
+    }
+
+    std::nth_element(ratios.begin(), ratios.begin() + runs / 2, ratios.end());
+    return ratios[runs / 2];
+}
+
+// The smallest of the sizes where the fast method wins, and from which on it's never clearly slower (the times
+// are noisy), given the ratios of the times of the fast and the slow method. If it doesn't win at the largest
+// size, a size above all of them.
+size_t crossover(const std::vector<size_t>& sizes, const std::vector<double>& ratios)
+{
+    size_t result = 2 * sizes.back();
+    for (size_t i = sizes.size(); i-- > 0 && ratios[i] <= 1.1; )
+        if (ratios[i] <= 1)
+            result = sizes[i];
+    return result;
+}
+
+// Schoolbook against one level of Karatsuba's method (with the schoolbook method below it), by operand length
+template<typename T>
+size_t tune_karatsuba(std::mt19937_64& random)
+{
+    const std::vector<size_t> sizes = { 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256 };
+    std::vector<double> ratios;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        const size_t n = sizes[i];
+        const CoefficientBuffer<T> a = random_buffer<T>(random, n), b = random_buffer<T>(random, n);
+        CoefficientBuffer<T> result(2 * n - 1);
+
+        const std::function<void()> schoolbook = [&]()
+        {
+            std::fill(result.begin(), result.end(), id_additive<T>::value);
+            _dense_multiply_add(a.data(), n, b.data(), n, result.data(), n + 1);
+        };
+        const std::function<void()> karatsuba = [&]()
+        {
+            std::fill(result.begin(), result.end(), id_additive<T>::value);
+            _dense_multiply_add(a.data(), n, b.data(), n, result.data(), n);
+        };
+        ratios.push_back(relative_time(karatsuba, schoolbook));
+    }
+    return crossover(sizes, ratios);
+}
+
+// Long division against Newton's, dividing 2n long polynomials by n long ones
+template<typename T>
+size_t tune_newton_division(std::mt19937_64& random)
+{
+    const std::vector<size_t> sizes = { 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+    std::vector<double> ratios;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        const size_t n = sizes[i];
+        const CoefficientBuffer<T> a = random_buffer<T>(random, 2 * n), b = random_buffer<T>(random, n);
+        CoefficientBuffer<T> quotient, remainder;
+
+        const std::function<void()> longDivision = [&]()
+        {
+            _dense_divide(a, b, quotient, remainder, n + 1);
+        };
+        const std::function<void()> newton = [&]()
+        {
+            _dense_divide(a, b, quotient, remainder, n);
+        };
+        ratios.push_back(relative_time(newton, longDivision));
+    }
+    return crossover(sizes, ratios);
+}
+
+// The long division in the map against the one on dense buffers, by the density of the divisor:
+// a degree 256 divisor with 257 / k members
+template<typename T>
+size_t tune_dense_division(std::mt19937_64& random)
+{
+    const size_t degree = 256;
+    const std::vector<size_t> sparsities = { 128, 96, 64, 48, 32, 24, 16, 12, 8, 6, 4, 3, 2, 1 };
+    std::vector<double> ratios;
+    for (size_t i = 0; i < sparsities.size(); ++i)
+    {
+        // A member at every k-th power, and the leading one
+        CoefficientBuffer<T> coefficients = random_buffer<T>(random, degree + 1);
+        for (size_t j = 0; j < degree; ++j)
+            if (j % sparsities[i] != 0)
+                coefficients[j] = id_additive<T>::value;
+
+        const CoefficientBuffer<T> dividends = random_buffer<T>(random, 2 * degree + 1);
+        const Polynomial<T> divisor(coefficients.cbegin(), coefficients.cend());
+        const Polynomial<T> dividend(dividends.cbegin(), dividends.cend());
+
+        // With the threshold 0 the division is never done on dense buffers, with degree + 1 always
+        const std::function<void()> sparse = [&]()
+        {
+            threshold_tuning<T>::divide(dividend, divisor, 0);
+        };
+        const std::function<void()> dense = [&]()
+        {
+            threshold_tuning<T>::divide(dividend, divisor, degree + 1);
+        };
+        ratios.push_back(relative_time(dense, sparse));
+    }
+
+    // The sparsities go downwards (the divisors get denser), so the crossover is the largest sparsity from which
+    // on the dense division wins (0 if it never does)
+    return (ratios.back() > 1 ? 0 : crossover(sparsities, ratios));
+}
+
+// The Euclidean steps of the half-gcd against one level of its recursion (with the steps below it), by the
+// length of the first polynomial
+template<typename T>
+size_t tune_half_gcd_recursion(std::mt19937_64& random)
+{
+    const std::vector<size_t> sizes = { 32, 48, 64, 96, 128, 192, 256, 384, 512 };
+    std::vector<double> ratios;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        const size_t n = sizes[i];
+        const CoefficientBuffer<T> a = random_buffer<T>(random, n), b = random_buffer<T>(random, n - 1);
+        HalfGcdMatrix<T> matrix;
+
+        const std::function<void()> euclidean = [&]()
+        {
+            _dense_half_gcd(a, b, matrix, n + 1);
+        };
+        const std::function<void()> recursive = [&]()
+        {
+            _dense_half_gcd(a, b, matrix, n);
+        };
+        ratios.push_back(relative_time(recursive, euclidean));
+    }
+    return crossover(sizes, ratios);
+}
+
+// Euclid's algorithm against one jump of the half-gcd (with the tuned recursion threshold) to the middle of the
+// remainder sequence, by the length of the first polynomial
+template<typename T>
+size_t tune_half_gcd(std::mt19937_64& random, const size_t recursion)
+{
+    const std::vector<size_t> sizes = { 512, 768, 1024, 1536, 2048, 3072, 4096, 6144 };
+    std::vector<double> ratios;
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        const size_t n = sizes[i];
+        const CoefficientBuffer<T> a = random_buffer<T>(random, n), b = random_buffer<T>(random, n - 1);
+        CoefficientBuffer<T> result;
+
+        const std::function<void()> euclid = [&]()
+        {
+            _dense_gcd(a, b, result, n + 1, recursion);
+        };
+        const std::function<void()> halfGcd = [&]()
+        {
+            _dense_gcd(a, b, result, n, recursion);
+        };
+        ratios.push_back(relative_time(halfGcd, euclid));
+    }
+    return crossover(sizes, ratios);
+}
+
+struct TunedThresholds
+{
+    std::string type;
+    size_t karatsuba;
+    size_t newtonDivision;
+    size_t denseDivision;
+    size_t halfGcd;
+    size_t halfGcdRecursion;
+};
+
+template<typename T>
+TunedThresholds tune(const std::string& type, const bool divisions, const bool gcd)
+{
+    std::mt19937_64 random(1);
+
+    std::cerr << "Tuning " << type << "..." << std::endl;
+    TunedThresholds result;
+    result.type = type;
+    result.karatsuba = tune_karatsuba<T>(random);
+
+    // The quotients of Rational polynomials overflow quickly, so their divisions keep the defaults
+    result.newtonDivision = (divisions ? tune_newton_division<T>(random) : NEWTON_DIVISION_THRESHOLD);
+    result.denseDivision = (divisions ? tune_dense_division<T>(random) : DENSE_DIVISION_THRESHOLD);
+
+    // The remainder sequences of floating point polynomials are only rounding errors, so only the exact fields
+    // have their gcd thresholds measured
+    result.halfGcdRecursion = (gcd ? tune_half_gcd_recursion<T>(random) : HALF_GCD_RECURSION_THRESHOLD);
+    result.halfGcd = (gcd ? tune_half_gcd<T>(random, result.halfGcdRecursion) : HALF_GCD_THRESHOLD);
+
+    std::cerr << "    karatsuba = " << result.karatsuba << ", newtonDivision = " << result.newtonDivision
+        << ", denseDivision = " << result.denseDivision << ", halfGcd = " << result.halfGcd
+        << ", halfGcdRecursion = " << result.halfGcdRecursion << std::endl;
+    return result;
+}
+
+void write_header(std::ostream& o, const std::vector<TunedThresholds>& thresholds)
+{
+    char date[64];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&now));
+
+    o << "// Generated by the tuning program (benchmark/tune.cpp) on " << date;
+#if defined(__VERSION__)
+    o << ", compiled with " << __VERSION__;
+#endif
+    o << "." << std::endl;
+    o << "// The thresholds measured on the machine, see Thresholds.hpp." << std::endl;
+    o << "#ifndef _TUNED_THRESHOLDS_H" << std::endl;
+    o << "#define _TUNED_THRESHOLDS_H" << std::endl;
+
+    for (size_t i = 0; i < thresholds.size(); ++i)
+    {
+        const TunedThresholds& tuned = thresholds[i];
+        o << std::endl;
+        if (tuned.type.find("ResidueNum") == 0)
+        {
+            o << "// Measured with M = " << TUNED_MODULUS << ", but used for every modulus (the arithmetic costs about the"
+                << std::endl << "// same for all of them; if yours differs, set TUNED_MODULUS in benchmark/tune.cpp and tune again)." << std::endl;
+            o << "template<long M> struct algorithm_thresholds<ResidueNum<M>> : default_algorithm_thresholds" << std::endl;
+        }
+        else
+            o << "template<> struct algorithm_thresholds<" << tuned.type << "> : default_algorithm_thresholds" << std::endl;
+        o << "{" << std::endl;
+        o << "    static const size_t karatsuba = " << tuned.karatsuba << ";" << std::endl;
+        o << "    static const size_t newtonDivision = " << tuned.newtonDivision << ";" << std::endl;
+        o << "    static const size_t denseDivision = " << tuned.denseDivision << ";" << std::endl;
+        o << "    static const size_t halfGcd = " << tuned.halfGcd << ";" << std::endl;
+        o << "    static const size_t halfGcdRecursion = " << tuned.halfGcdRecursion << ";" << std::endl;
+        o << "};" << std::endl;
+    }
+
+    o << std::endl << "#endif // _TUNED_THRESHOLDS_H" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const std::string output = (argc > 1 ? argv[1] : "TunedThresholds.hpp");
+
+    std::vector<TunedThresholds> thresholds;
+    thresholds.push_back(tune<double>("double", true, false));
+    thresholds.push_back(tune<Complex>("Complex", true, false));
+    thresholds.push_back(tune<Residue998>("ResidueNum<M>", true, true));
+    thresholds.push_back(tune<Rational>("Rational", false, false));
+
+    std::ofstream file(output.c_str());
+    if (!file)
+    {
+        std::cerr << "Can't write " << output << std::endl;
+        return 1;
+    }
+    write_header(file, thresholds);
+
+    std::cerr << "Written " << output << std::endl;
+    return 0;
+}
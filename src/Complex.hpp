@@ -2,6 +2,7 @@
 #define _COMPLEX_H
 
 #include <algorithm>
+#include <functional>
 #include <iosfwd>
 #include <complex>
 #include <cmath>
@@ -163,6 +164,19 @@ Complex const id_additive<Complex>::value = // 0 + 0i
     Complex(id_additive<long double>::value, id_additive<long double>::value);
 #endif // _ADD_MULT_IDENTITY_H
 
+// Hash complex numbers by their parts so they can be used as keys of unordered containers.
+namespace std
+{
+    template<>
+    struct hash<Complex>
+    {
+        size_t operator()(const Complex& cmplx) const
+        {
+            return std::hash<long double>()(cmplx.re()) * 31 + std::hash<long double>()(cmplx.im());
+        }
+    };
+}
+
 #ifdef _POLYNOMIAL_H
 template<>
 std::ostream& operator << (std::ostream& o, const Polynomial<Complex>& poly)
@@ -0,0 +1,201 @@
+#ifndef _COMPOSITION_H
+#define _COMPOSITION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "Residue.hpp"
+
+// Composition of polynomials, f(g(x)), and its most common case, the Taylor shift f(x + a).
+//
+// Substituting into Horner's scheme costs n multiplications of growing polynomials. Divide and conquer is
+// cheaper: with f = f0 + x^h * f1 (h a power of 2),
+//     f(g) = f0(g) + g^h * f1(g)
+// so the coefficients are combined pairwise, then the pairs pairwise with g^2, etc., with the powers g^(2^k)
+// calculated by squaring. Every level costs about as much as one multiplication of the full size, so the whole
+// composition costs O(M(n*m) log n) where M is the cost of a multiplication (see DenseMultiplication.hpp).
+//
+// The Taylor shift can be done with a single multiplication if 1, 2, ..., n can be divided by: with
+// u_j = f_j * j! and v_k = a^k / k! the coefficients of f(x + a) are
+//     (1 / i!) * sum_k u_(i+k) * v_k
+// which is a convolution of the reversed u and v. This is only done for residues, where it is exact. Everywhere
+// else the shift is done as the composition with x + a: integers and Rational can't divide by the factorials (or
+// they would overflow long before the binomial coefficients of the result do), and in floating point the terms
+// u_(i+k) * v_k are many orders of magnitude larger than their sum, so it would cancel out (from degree 171 on,
+// the factorials of double are even infinite).
+
+// Whether the Taylor shift may divide by the factorials of the coefficient type
+template<typename T>
+struct taylor_shift_by_convolution : std::false_type
+{
+};
+
+// (It's checked at run time that the factorials don't vanish modulo M, that is M is above the degree.)
+template<long M> struct taylor_shift_by_convolution<ResidueNum<M>> : std::true_type{};
+
+// result = f(g) mod x^limit
+template<typename T>
+void _dense_compose(const CoefficientBuffer<T>& f, const CoefficientBuffer<T>& g, const size_t limit,
+    CoefficientBuffer<T>& result)
+{
+    if (f.empty() || limit == 0)
+    {
+        result.clear();
+        return;
+    }
+
+    // The coefficients of f are the polynomials of the first level
+    std::vector<CoefficientBuffer<T>> blocks(f.size());
+    for (size_t i = 0; i < f.size(); ++i)
+        blocks[i].assign(1, f[i]);
+
+    CoefficientBuffer<T> power(g.begin(), g.begin() + std::min(g.size(), limit)), product;
+    while (blocks.size() > 1)
+    {
+        // blocks[2i] + g^h * blocks[2i + 1]
+        std::vector<CoefficientBuffer<T>> next((blocks.size() + 1) / 2);
+        for (size_t i = 0; i < next.size(); ++i)
+        {
+            next[i].swap(blocks[2 * i]);
+            if (2 * i + 1 == blocks.size())
+                continue;
+
+            dense_multiply(power, blocks[2 * i + 1], product);
+            if (product.size() > limit)
+                product.resize(limit);
+
+            if (next[i].size() < product.size())
+                next[i].resize(product.size(), id_additive<T>::value);
+            for (size_t j = 0; j < product.size(); ++j)
+                next[i][j] = next[i][j] + product[j];
+        }
+        blocks.swap(next);
+
+        if (blocks.size() > 1)
+        {
+            dense_multiply(power, power, product);
+            if (product.size() > limit)
+                product.resize(limit);
+            power.swap(product);
+        }
+    }
+
+    result.swap(blocks[0]);
+}
+
+// result = f(g)
+template<typename T>
+void dense_compose(const CoefficientBuffer<T>& f, const CoefficientBuffer<T>& g, CoefficientBuffer<T>& result)
+{
+    const size_t limit = (f.empty() ? 0 : (f.size() - 1) * (g.empty() ? 0 : g.size() - 1) + 1);
+    _dense_compose(f, g, limit, result);
+}
+
+// result = f(g) mod x^n
+template<typename T>
+void dense_compose_truncated(const CoefficientBuffer<T>& f, const CoefficientBuffer<T>& g, const size_t n,
+    CoefficientBuffer<T>& result)
+{
+    _dense_compose(f, g, n, result);
+    result.resize(n, id_additive<T>::value);
+}
+
+// result = f(x + a) with one convolution, returns false if a factorial vanishes
+template<typename T>
+bool _dense_taylor_shift_convolution(const CoefficientBuffer<T>& f, const T& a, CoefficientBuffer<T>& result)
+{
+    const size_t n = f.size();
+
+    // j! and 1/j!
+    CoefficientBuffer<T> factorials(n, id_multiplicative<T>::value), inverses(n, id_multiplicative<T>::value);
+    T index = id_multiplicative<T>::value;
+    for (size_t j = 1; j < n; ++j)
+    {
+        factorials[j] = factorials[j - 1] * index;
+        index += id_multiplicative<T>::value;
+    }
+    if (factorials[n - 1] == id_additive<T>::value)
+        return false;
+
+    inverses[n - 1] = id_multiplicative<T>::value / factorials[n - 1];
+    for (size_t j = n - 1; j > 1; --j)
+    {
+        index = index - id_multiplicative<T>::value;
+        inverses[j - 1] = inverses[j] * index;
+    }
+
+    // The reversed u_j = f_j * j!, and v_k = a^k / k!
+    CoefficientBuffer<T> u(n), v(n), convolution;
+    T power = id_multiplicative<T>::value;
+    for (size_t j = 0; j < n; ++j)
+    {
+        u[n - 1 - j] = f[j] * factorials[j];
+        v[j] = power * inverses[j];
+        power = power * a;
+    }
+
+    dense_multiply_truncated(u, v, n, convolution);
+
+    result.resize(n);
+    for (size_t i = 0; i < n; ++i)
+        result[i] = convolution[n - 1 - i] * inverses[i];
+    return true;
+}
+
+// result = f(x + a)
+template<typename T>
+void dense_taylor_shift(const CoefficientBuffer<T>& f, const T& a, CoefficientBuffer<T>& result)
+{
+    if (f.size() <= 1 || a == id_additive<T>::value)
+    {
+        result = f;
+        return;
+    }
+
+    if (taylor_shift_by_convolution<T>::value && _dense_taylor_shift_convolution(f, a, result))
+        return;
+
+    CoefficientBuffer<T> g(2, id_multiplicative<T>::value);
+    g[0] = a;
+    dense_compose(f, g, result);
+}
+
+/* The same on polynomials */
+// f(x + a)
+template<typename T>
+Polynomial<T> taylor_shift(const Polynomial<T>& f, const T& a)
+{
+    CoefficientBuffer<T> coefficients, result;
+    f.getCoefficients(coefficients);
+    dense_taylor_shift(coefficients, a, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// f(g(x))
+template<typename T>
+Polynomial<T> compose(const Polynomial<T>& f, const Polynomial<T>& g)
+{
+    CoefficientBuffer<T> lefts, rights, result;
+    f.getCoefficients(lefts);
+    g.getCoefficients(rights);
+    dense_compose(lefts, rights, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// f(g(x)) mod x^n
+template<typename T>
+Polynomial<T> series_compose(const Polynomial<T>& f, const Polynomial<T>& g, const size_t n)
+{
+    CoefficientBuffer<T> lefts, rights, result;
+    f.getCoefficients(lefts);
+    g.getCoefficients(rights);
+    dense_compose_truncated(lefts, rights, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+#endif // _COMPOSITION_H
@@ -0,0 +1,115 @@
+#ifndef _DENSE_MULTIPLICATION_H
+#define _DENSE_MULTIPLICATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include "add_mult_identity.hpp"
+#include "Instrumentation.hpp"
+#include "MemoryResource.hpp"
+#include "SimdKernels.hpp"
+#include "Thresholds.hpp"
+
+// Multiplication of densely stored coefficient sequences (the ith element being the coefficient of x^i).
+//
+// Short operands are multiplied with the schoolbook method. Above the threshold Karatsuba's method is used:
+// splitting both operands in half, a0 + a1*x^h and b0 + b1*x^h, the product is
+//     a0*b0 + ((a0 + a1)*(b0 + b1) - a0*b0 - a1*b1)*x^h + a1*b1*x^2h
+// which needs three half-sized products instead of four, so the cost is O(n^1.58) instead of O(n^2).
+
+// (The threshold of the schoolbook method is KARATSUBA_THRESHOLD, or the tuned one, see Thresholds.hpp.)
+
+// result[0 .. n+m-2] += a[0 .. n-1] * b[0 .. m-1], with the schoolbook method below the given length
+template<typename T>
+void _dense_multiply_add(const T* a, const size_t n, const T* b, const size_t m, T* result, const size_t threshold)
+{
+    if (n == 0 || m == 0)
+        return;
+
+    // Make a the longer operand
+    if (n < m)
+    {
+        _dense_multiply_add(b, m, a, n, result, threshold);
+        return;
+    }
+
+    if (m < threshold || m < 2)
+    {
+        // Every row is a multiply-add of b (see SimdKernels.hpp)
+        for (size_t i = 0; i < n; ++i)
+        {
+            const T& left = a[i];
+            if (left == id_additive<T>::value) continue; // 0 * anything = 0
+
+            simd_multiply_add(b, left, result + i, m);
+        }
+    }
+    else if (n > m)
+    {
+        // Unbalanced operands: multiply b with the m long slices of a, so every product is balanced
+        for (size_t offset = 0; offset < n; offset += m)
+            _dense_multiply_add(a + offset, std::min(m, n - offset), b, m, result + offset, threshold);
+    }
+    else
+    {
+        // Both are n long: a = a0 + a1*x^h, b = b0 + b1*x^h, with a0 and b0 being h long
+        const size_t h = n / 2;
+        const size_t high = n - h;
+
+        // The sums a0 + a1 and b0 + b1
+        CoefficientBuffer<T> sums(2 * high, id_additive<T>::value);
+        for (size_t i = 0; i < high; ++i)
+        {
+            sums[i] = (i < h ? a[i] + a[h + i] : a[h + i]);
+            sums[high + i] = (i < h ? b[i] + b[h + i] : b[h + i]);
+        }
+
+        CoefficientBuffer<T> low(2 * h - 1, id_additive<T>::value);
+        CoefficientBuffer<T> top(2 * high - 1, id_additive<T>::value);
+        CoefficientBuffer<T> middle(2 * high - 1, id_additive<T>::value);
+        _dense_multiply_add(a, h, b, h, low.data(), threshold);
+        _dense_multiply_add(a + h, high, b + h, high, top.data(), threshold);
+        _dense_multiply_add(sums.data(), high, sums.data() + high, high, middle.data(), threshold);
+
+        simd_add(result, low.data(), result, low.size());
+        simd_subtract(middle.data(), low.data(), middle.data(), low.size());
+        simd_add(result + 2 * h, top.data(), result + 2 * h, top.size());
+        simd_subtract(middle.data(), top.data(), middle.data(), top.size());
+        simd_add(result + h, middle.data(), result + h, middle.size());
+
+        // a0 + a1 and b0 + b1 (the kernels count the rest)
+        POLYNOM_COUNT(additions, 2 * h);
+    }
+}
+
+// result[0 .. n+m-2] += a[0 .. n-1] * b[0 .. m-1]
+template<typename T>
+void dense_multiply_add(const T* a, const size_t n, const T* b, const size_t m, T* result)
+{
+    _dense_multiply_add(a, n, b, m, result, algorithm_thresholds<T>::karatsuba);
+}
+
+// result = a * b
+template<typename T>
+void dense_multiply(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, CoefficientBuffer<T>& result)
+{
+    POLYNOM_PHASE("multiply");
+    result.assign(a.empty() || b.empty() ? 0 : a.size() + b.size() - 1, id_additive<T>::value);
+    dense_multiply_add(a.data(), a.size(), b.data(), b.size(), result.data());
+}
+
+// result = a * b mod x^length, that is only the lowest length coefficients of the product.
+// (The members of the operands above x^length do not affect these, so they are not even looked at.)
+template<typename T>
+void dense_multiply_truncated(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, const size_t length,
+    CoefficientBuffer<T>& result)
+{
+    POLYNOM_PHASE("multiply");
+    const size_t n = std::min(a.size(), length);
+    const size_t m = std::min(b.size(), length);
+
+    result.assign(n == 0 || m == 0 ? 0 : n + m - 1, id_additive<T>::value);
+    dense_multiply_add(a.data(), n, b.data(), m, result.data());
+    result.resize(length, id_additive<T>::value);
+}
+
+#endif // _DENSE_MULTIPLICATION_H
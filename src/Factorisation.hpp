@@ -0,0 +1,453 @@
+#ifndef _FACTORISATION_H
+#define _FACTORISATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "PolynomialGcd.hpp"
+#include "PolynomialPower.hpp"
+#include "PowerSeries.hpp"
+#include "Residue.hpp"
+
+// Factorisation of polynomials over prime fields: Polynomial<ResidueNum<P>>, where P must be a prime.
+//
+// The factorisation happens in three stages:
+//  1. Squarefree factorisation splits f into squarefree polynomials g1, g2, ... with f = lc * g1 * g2^2 * ...
+//     (Over Zp, f' = 0 does not mean that f is a constant: then f is a polynomial of x^p, that is, a p-th power.)
+//  2. Distinct-degree factorisation splits a squarefree polynomial into the products of its irreducible factors
+//     of the same degree: x^(p^d) - x is the product of every monic irreducible polynomial whose degree divides d,
+//     so gcd(f, x^(p^d) - x mod f) collects the factors of degree d, after the smaller ones were removed.
+//  3. Equal-degree factorisation (Cantor and Zassenhaus) splits a product of irreducible polynomials of degree d:
+//     for a random h, h^((p^d - 1) / 2) is 1 modulo about half of the factors and -1 modulo the other half,
+//     so gcd(f, h^((p^d - 1) / 2) - 1) is a proper factor of f with a good chance. (For p = 2 the trace
+//     h + h^2 + h^4 + ... + h^(2^(d-1)) does the same.)
+//
+// The powers are calculated with a precomputed modulus and the gcds with the half-gcd algorithm.
+//
+// Finding the roots only needs the linear factors: gcd(f, x^p - x) is their product, which is split the same way.
+
+// The number of degrees whose gcd is calculated at once by the distinct-degree factorisation
+const size_t DISTINCT_DEGREE_BLOCK = 8;
+
+// An irreducible (or squarefree) monic factor and its multiplicity
+template<typename T>
+struct PolynomialFactor
+{
+    Polynomial<T> factor;
+    size_t multiplicity;
+};
+
+// A root and its multiplicity
+template<typename T>
+struct PolynomialRoot
+{
+    T root;
+    size_t multiplicity;
+};
+
+// The product of the irreducible factors of the given degree
+template<typename T>
+struct DistinctDegreeFactor
+{
+    Polynomial<T> product;
+    size_t degree;
+};
+
+// f = lc(f) * g1 * g2^2 * g3^3 * ..., where the gi are monic, squarefree and coprime.
+// The result contains the non-constant gi with multiplicity i.
+template<long P>
+std::vector<PolynomialFactor<ResidueNum<P>>> squarefree_factorisation(const Polynomial<ResidueNum<P>>& f)
+{
+    typedef ResidueNum<P> T;
+
+    if (f.isNull())
+        throw std::invalid_argument("The nullpolynomial can not be factorised.");
+
+    std::vector<PolynomialFactor<T>> result;
+    CoefficientBuffer<T> c, w, y, derivative, quotient, remainder;
+    f.getCoefficients(c);
+    dense_make_monic(c);
+
+    size_t power = 1; // The multiplicity of the factors is multiplied by this (p^k after k p-th roots)
+    while (c.size() > 1)
+    {
+        // w is the product of every distinct factor whose multiplicity is not divisible by p,
+        // c keeps the rest: gcd(f, f') loses one of every such factor.
+        dense_series_derivative(c, derivative);
+        dense_trim(derivative);
+        dense_gcd(c, derivative, y);
+        dense_divide(c, y, w, remainder);
+        c.swap(y);
+
+        // Peel off the factors of multiplicity 1, 2, ... one after the other
+        for (size_t i = 1; w.size() > 1; ++i)
+        {
+            dense_gcd(w, c, y);
+            dense_divide(w, y, quotient, remainder);
+            if (quotient.size() > 1)
+            {
+                PolynomialFactor<T> factor;
+                factor.factor = Polynomial<T>(quotient.cbegin(), quotient.cend());
+                factor.multiplicity = i * power;
+                result.push_back(factor);
+            }
+
+            w.swap(y);
+            dense_divide(c, w, quotient, remainder);
+            c.swap(quotient);
+        }
+
+        // What remained is a polynomial of x^p: take its p-th root (a^p = a for every a in Zp)
+        if (c.size() > 1)
+        {
+            for (size_t i = 0; i * P < c.size(); ++i)
+                c[i] = c[i * P];
+            c.resize((c.size() - 1) / P + 1);
+            power *= P;
+        }
+    }
+
+    return result;
+}
+
+// The matrix of the Frobenius map h -> h^p modulo f: the ith row is x^(i*p) mod f.
+// Over Zp, (a + b)^p = a^p + b^p and c^p = c for the coefficients, so h^p = sum hi * x^(i*p): a matrix-vector product.
+template<long P>
+void _frobenius_matrix(const PolynomialModulus<ResidueNum<P>>& modulus, std::vector<CoefficientBuffer<ResidueNum<P>>>& rows)
+{
+    typedef ResidueNum<P> T;
+
+    Polynomial<T> x;
+    x.setMember(1, id_multiplicative<T>::value);
+
+    CoefficientBuffer<T> frobenius;
+    powmod(x, P, modulus).getCoefficients(frobenius);
+
+    rows.resize(modulus.modulus().degree());
+    rows[0].assign(1, id_multiplicative<T>::value);
+    modulus.reduce(rows[0]);
+    for (size_t i = 1; i < rows.size(); ++i)
+        modulus.multiply(rows[i - 1], frobenius, rows[i]);
+}
+
+// result = h^p mod f with the matrix of the Frobenius map
+template<long P>
+void _frobenius_apply(const std::vector<CoefficientBuffer<ResidueNum<P>>>& rows, const CoefficientBuffer<ResidueNum<P>>& h,
+    CoefficientBuffer<ResidueNum<P>>& result)
+{
+    typedef ResidueNum<P> T;
+
+    // This is the hot loop of the distinct-degree factorisation, so it's done on the representatives directly.
+    // The products are summed without reduction while the sums can't overflow. (For small moduli, that means
+    // never: the remainders are only taken at the end.)
+    const unsigned long limit = std::max(std::numeric_limits<unsigned long>::max() / ((unsigned long)(P - 1) * (P - 1)),
+        (unsigned long)2) - 1;
+
+    std::vector<unsigned long> sums(rows.size(), 0);
+    unsigned long terms = 0;
+    for (size_t i = 0; i < h.size() && i < rows.size(); ++i)
+    {
+        const unsigned long factor = h[i].number();
+        if (factor == 0) continue;
+
+        if (terms++ == limit)
+        {
+            for (size_t j = 0; j < sums.size(); ++j)
+                sums[j] %= P;
+            terms = 1;
+        }
+
+        for (size_t j = 0; j < rows[i].size(); ++j)
+            sums[j] += factor * (unsigned long)rows[i][j].number();
+    }
+
+    result.resize(sums.size());
+    for (size_t j = 0; j < sums.size(); ++j)
+        result[j] = T((long)(sums[j] % P));
+}
+
+// Split a monic squarefree polynomial into the products of its irreducible factors of the same degree
+template<long P>
+std::vector<DistinctDegreeFactor<ResidueNum<P>>> distinct_degree_factorisation(const Polynomial<ResidueNum<P>>& f)
+{
+    typedef ResidueNum<P> T;
+
+    std::vector<DistinctDegreeFactor<T>> result;
+    CoefficientBuffer<T> rest, power, next, g, quotient, remainder;
+    f.getCoefficients(rest);
+
+    if (f.degree() >= 2)
+    {
+        // Applying the Frobenius map is much cheaper than raising to the pth power every time
+        PolynomialModulus<T> modulus(f);
+        std::vector<CoefficientBuffer<T>> frobenius;
+        _frobenius_matrix<P>(modulus, frobenius);
+
+        // x^(p^d) is calculated modulo f all the time, not modulo the rest:
+        // gcd(rest, x^(p^d) - x) is the same either way, because the rest divides f.
+        power.assign(f.degree(), id_additive<T>::value);
+        power[1] = id_multiplicative<T>::value;
+
+        // A gcd costs much more than a multiplication, so the x^(p^d) - x of a few degrees are multiplied together
+        // and the gcd is taken with their product. Only if that has a factor, the degrees are checked one by one.
+        std::vector<CoefficientBuffer<T>> block;
+        CoefficientBuffer<T> product;
+        for (size_t d = 1; 2 * d < rest.size(); )
+        {
+            const size_t first = d;
+            product.assign(1, id_multiplicative<T>::value);
+            block.clear();
+
+            for (; block.size() < DISTINCT_DEGREE_BLOCK && 2 * d < rest.size(); ++d)
+            {
+                _frobenius_apply<P>(frobenius, power, next);
+                power.swap(next);
+
+                block.push_back(power);
+                block.back()[1] = block.back()[1] - id_multiplicative<T>::value;
+                modulus.multiply(product, block.back(), next);
+                product.swap(next);
+            }
+
+            dense_gcd(rest, product, g);
+            if (g.size() == 1)
+                continue;
+
+            for (size_t i = 0; i < block.size() && rest.size() > 1; ++i)
+            {
+                dense_gcd(rest, block[i], g);
+                if (g.size() > 1)
+                {
+                    DistinctDegreeFactor<T> factor;
+                    factor.product = Polynomial<T>(g.cbegin(), g.cend());
+                    factor.degree = first + i;
+                    result.push_back(factor);
+
+                    dense_divide(rest, g, quotient, remainder);
+                    rest.swap(quotient);
+                }
+            }
+        }
+    }
+
+    // Every factor of the rest is of higher degree than the half of it: so it's irreducible.
+    if (rest.size() > 1)
+    {
+        DistinctDegreeFactor<T> factor;
+        factor.product = Polynomial<T>(rest.cbegin(), rest.cend());
+        factor.degree = rest.size() - 1;
+        result.push_back(factor);
+    }
+
+    return result;
+}
+
+// Split a monic product of distinct irreducible polynomials of degree d into its factors.
+// The random generator picks the polynomials which split it.
+template<long P, typename Generator>
+std::vector<Polynomial<ResidueNum<P>>> equal_degree_factorisation(const Polynomial<ResidueNum<P>>& f,
+    const size_t d, Generator& random)
+{
+    typedef ResidueNum<P> T;
+
+    std::vector<Polynomial<T>> result;
+    if (f.degree() <= d)
+    {
+        result.push_back(f);
+        return result;
+    }
+
+    const size_t n = f.degree();
+    PolynomialModulus<T> modulus(f);
+    std::uniform_int_distribution<long> coefficient(0, P - 1);
+
+    Polynomial<T> g;
+    do
+    {
+        // A random polynomial of degree < n
+        CoefficientBuffer<T> coefficients(n, id_additive<T>::value);
+        for (size_t i = 0; i < n; ++i)
+            coefficients[i] = T(coefficient(random));
+        Polynomial<T> h(coefficients.cbegin(), coefficients.cend());
+
+        // A lucky hit
+        g = polynomial_gcd(h, f);
+        if (!g.isConstant() && g.degree() < n)
+            break;
+
+        Polynomial<T> split;
+        if (P == 2)
+        {
+            // The trace h + h^2 + h^4 + ... + h^(2^(d-1)) mod f, which is 0 or 1 modulo every factor
+            Polynomial<T> term = h;
+            split = h;
+            for (size_t i = 1; i < d; ++i)
+            {
+                term = powmod(term, 2, modulus);
+                split += term;
+            }
+        }
+        else
+        {
+            // h^((p^d - 1) / 2) = (h * h^p * ... * h^(p^(d-1)))^((p - 1) / 2), without the huge exponent
+            Polynomial<T> term = h, norm = h;
+            for (size_t i = 1; i < d; ++i)
+            {
+                term = powmod(term, P, modulus);
+                norm = modulus.reduce(norm * term);
+            }
+            split = powmod(norm, (P - 1) / 2, modulus) - Polynomial<T>(id_multiplicative<T>::value);
+        }
+
+        g = polynomial_gcd(split, f);
+    }
+    while (g.isConstant() || g.degree() == n);
+
+    // Both parts are products of irreducible factors of degree d, so split them further
+    std::vector<Polynomial<T>> left = equal_degree_factorisation<P>(g, d, random);
+    std::vector<Polynomial<T>> right = equal_degree_factorisation<P>(f / g, d, random);
+    result.insert(result.end(), left.begin(), left.end());
+    result.insert(result.end(), right.begin(), right.end());
+    return result;
+}
+
+// Order factors by their degree, then by their coefficients from the top
+template<typename T>
+bool _factor_less(const PolynomialFactor<T>& a, const PolynomialFactor<T>& b)
+{
+    if (a.factor.degree() != b.factor.degree())
+        return a.factor.degree() < b.factor.degree();
+
+    for (size_t i = a.factor.degree() + 1; i-- > 0; )
+        if (a.factor.getMember(i) != b.factor.getMember(i))
+            return a.factor.getMember(i) < b.factor.getMember(i);
+
+    return a.multiplicity < b.multiplicity;
+}
+
+// Factorise f into monic irreducible polynomials: f = lc(f) * f1^e1 * f2^e2 * ...
+// The factors are ordered by their degree (and coefficients), so the result does not depend on the randomness.
+template<long P>
+std::vector<PolynomialFactor<ResidueNum<P>>> factorise(const Polynomial<ResidueNum<P>>& f)
+{
+    typedef ResidueNum<P> T;
+
+    std::vector<PolynomialFactor<T>> result;
+    std::mt19937_64 random;
+
+    std::vector<PolynomialFactor<T>> squarefree = squarefree_factorisation<P>(f);
+    for (size_t i = 0; i < squarefree.size(); ++i)
+    {
+        std::vector<DistinctDegreeFactor<T>> distinct = distinct_degree_factorisation<P>(squarefree[i].factor);
+        for (size_t j = 0; j < distinct.size(); ++j)
+        {
+            std::vector<Polynomial<T>> irreducibles =
+                equal_degree_factorisation<P>(distinct[j].product, distinct[j].degree, random);
+
+            for (size_t k = 0; k < irreducibles.size(); ++k)
+            {
+                PolynomialFactor<T> factor;
+                factor.factor = irreducibles[k];
+                factor.multiplicity = squarefree[i].multiplicity;
+                result.push_back(factor);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end(), _factor_less<T>);
+    return result;
+}
+
+// Collect the roots of a monic product of distinct linear factors
+template<long P, typename Generator>
+void _split_linear(const Polynomial<ResidueNum<P>>& f, Generator& random, std::vector<ResidueNum<P>>& roots)
+{
+    typedef ResidueNum<P> T;
+
+    if (f.degree() == 0)
+        return;
+
+    if (f.degree() == 1)
+    {
+        // x + c has the root -c
+        roots.push_back(id_additive<T>::value - f.getMember(0));
+        return;
+    }
+
+    if (P == 2)
+    {
+        // The only candidates are 0 and 1, and both of them are roots. (That's x^2 + x.)
+        roots.push_back(id_additive<T>::value);
+        roots.push_back(id_multiplicative<T>::value);
+        return;
+    }
+
+    PolynomialModulus<T> modulus(f);
+    std::uniform_int_distribution<long> shift(0, P - 1);
+
+    Polynomial<T> g;
+    do
+    {
+        // (x + a)^((p - 1) / 2) is 1 at about half of the roots (where x + a is a square) and -1 or 0 at the others
+        Polynomial<T> h;
+        h.setMember(1, id_multiplicative<T>::value);
+        h.setMember(0, T(shift(random)));
+
+        g = polynomial_gcd(f, powmod(h, (P - 1) / 2, modulus) - Polynomial<T>(id_multiplicative<T>::value));
+    }
+    while (g.degree() == 0 || g.degree() == f.degree());
+
+    _split_linear<P>(g, random, roots);
+    _split_linear<P>(f / g, random, roots);
+}
+
+// Find the roots of f in Zp, with their multiplicities, in increasing order.
+// Instead of trying every element, the roots are separated from the rest of f by gcd(f, x^p - x),
+// then the linear factors of that are split with random gcds.
+template<long P>
+std::vector<PolynomialRoot<ResidueNum<P>>> roots(const Polynomial<ResidueNum<P>>& f)
+{
+    typedef ResidueNum<P> T;
+
+    std::vector<PolynomialRoot<T>> result;
+    std::mt19937_64 random;
+
+    Polynomial<T> x;
+    x.setMember(1, id_multiplicative<T>::value);
+
+    // The roots of the squarefree parts have the multiplicity of the part
+    std::vector<PolynomialFactor<T>> squarefree = squarefree_factorisation<P>(f);
+    for (size_t i = 0; i < squarefree.size(); ++i)
+    {
+        const Polynomial<T>& g = squarefree[i].factor;
+
+        // x^p - x is the product of (x - a) for every a in Zp
+        PolynomialModulus<T> modulus(g);
+        Polynomial<T> linear = polynomial_gcd(g, powmod(x, P, modulus) - x);
+
+        std::vector<T> found;
+        _split_linear<P>(linear, random, found);
+        for (size_t j = 0; j < found.size(); ++j)
+        {
+            PolynomialRoot<T> root;
+            root.root = found[j];
+            root.multiplicity = squarefree[i].multiplicity;
+            result.push_back(root);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const PolynomialRoot<T>& a, const PolynomialRoot<T>& b)
+        {
+            return a.root < b.root;
+        });
+    return result;
+}
+
+#endif // _FACTORISATION_H
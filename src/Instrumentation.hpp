@@ -0,0 +1,173 @@
+#ifndef _INSTRUMENTATION_H
+#define _INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+// Optional instrumentation: operation counters and timed phases, to see where the time of an algorithm goes.
+//
+// It is compiled in only if POLYNOM_INSTRUMENTATION is defined (before including any header of the library).
+// Otherwise the hooks are empty macros which don't even evaluate their arguments, so they cost nothing.
+//
+// The statistics are kept per thread: OperationStatistics::current() gives the ones of the calling thread.
+// (Work done on the threads of a ThreadPool is counted in the statistics of the worker threads.)
+//
+//     OperationStatistics::current().reset();
+//     lagrange.build();
+//     std::cout << OperationStatistics::current().reductions << std::endl;
+//
+// The counters:
+//     multiplications, additions   coefficient operations in the polynomial kernels (the dense multiplication,
+//                                  the long divisions, Horner's scheme, the scalar operations, Lagrange's basis)
+//     simplifications              the gcd calculations of Rational::_simplify()
+//     reductions                   the modulo operations of the residues (ResidueNum values already in range
+//                                  are not reduced)
+//     cleanups                     the calls of Polynomial::_performCleanup()
+//     allocations, allocatedBytes  allocations through a ResourceAllocator (the polynomials and the buffers)
+//
+// The phases are timed scopes of the algorithms (like "lagrange.basis" or "gcd.half_gcd"). A phase can contain
+// other phases, its time includes theirs.
+
+// The statistics of a timed phase
+struct PhaseStatistics
+{
+    const char* name;
+    unsigned long long calls;
+    unsigned long long nanoseconds;
+};
+
+class OperationStatistics
+{
+    public:
+        OperationStatistics();
+
+        unsigned long long multiplications;
+        unsigned long long additions;
+        unsigned long long simplifications;
+        unsigned long long reductions;
+        unsigned long long cleanups;
+        unsigned long long allocations;
+        unsigned long long allocatedBytes;
+
+        // Zero everything
+        void reset();
+
+        // The phases in the order of their first use, or the one with the given name (nullptr if never used)
+        const std::vector<PhaseStatistics>& phases() const;
+        const PhaseStatistics* phase(const char* name) const;
+
+        // Record a call of a phase
+        void addPhase(const char* name, const unsigned long long nanoseconds);
+
+        // The statistics of the calling thread
+        static OperationStatistics& current();
+
+        // Whether the library was compiled with the hooks
+        static bool enabled();
+
+    private:
+        std::vector<PhaseStatistics> m_phases;
+};
+
+// Times its own lifetime as a call of the phase (on the statistics of the thread it was created on)
+class PhaseTimer
+{
+    public:
+        PhaseTimer(const char* name);
+        ~PhaseTimer();
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator = (const PhaseTimer&) = delete;
+
+    private:
+        const char* m_name;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+OperationStatistics::OperationStatistics()
+{
+    this->reset();
+}
+
+void OperationStatistics::reset()
+{
+    this->multiplications = 0;
+    this->additions = 0;
+    this->simplifications = 0;
+    this->reductions = 0;
+    this->cleanups = 0;
+    this->allocations = 0;
+    this->allocatedBytes = 0;
+    this->m_phases.clear();
+}
+
+const std::vector<PhaseStatistics>& OperationStatistics::phases() const
+{
+    return this->m_phases;
+}
+
+const PhaseStatistics* OperationStatistics::phase(const char* name) const
+{
+    for (size_t i = 0; i < this->m_phases.size(); ++i)
+        if (std::strcmp(this->m_phases[i].name, name) == 0)
+            return &this->m_phases[i];
+    return nullptr;
+}
+
+void OperationStatistics::addPhase(const char* name, const unsigned long long nanoseconds)
+{
+    // There are only a few phases, so a linear search is fine
+    for (size_t i = 0; i < this->m_phases.size(); ++i)
+        if (std::strcmp(this->m_phases[i].name, name) == 0)
+        {
+            ++this->m_phases[i].calls;
+            this->m_phases[i].nanoseconds += nanoseconds;
+            return;
+        }
+
+    PhaseStatistics phase = { name, 1, nanoseconds };
+    this->m_phases.push_back(phase);
+}
+
+OperationStatistics& OperationStatistics::current()
+{
+    static thread_local OperationStatistics statistics;
+    return statistics;
+}
+
+bool OperationStatistics::enabled()
+{
+#ifdef POLYNOM_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+PhaseTimer::PhaseTimer(const char* name)
+{
+    this->m_name = name;
+    this->m_start = std::chrono::steady_clock::now();
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - this->m_start;
+    OperationStatistics::current().addPhase(this->m_name,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+// The hooks: POLYNOM_COUNT(counter, n) adds n to a counter, POLYNOM_PHASE("name") times the rest of the scope
+#ifdef POLYNOM_INSTRUMENTATION
+#define _POLYNOM_CONCATENATE(a, b) a##b
+#define _POLYNOM_PHASE_VARIABLE(line) _POLYNOM_CONCATENATE(_polynom_phase_, line)
+#define POLYNOM_COUNT(counter, n) (OperationStatistics::current().counter += (n))
+#define POLYNOM_PHASE(name) PhaseTimer _POLYNOM_PHASE_VARIABLE(__LINE__)(name)
+#else
+#define POLYNOM_COUNT(counter, n) ((void)0)
+#define POLYNOM_PHASE(name) ((void)0)
+#endif
+
+#endif // _INSTRUMENTATION_H
@@ -1,13 +1,18 @@
 #ifndef _LAGRANGE_H
 #define _LAGRANGE_H
 
-#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "add_mult_identity.hpp"
+#include "Instrumentation.hpp"
 #include "Polynomial.hpp"
+#include "ThreadPool.hpp"
 
 // The template T here is just a wrapper for the internal polynomial's type.
 // As so, the same restrictions apply.
+// Additionally, T must be hashable (std::hash<T> must exist), because the pairs are indexed by their Ci.
 
 // Lagrange interpolation creates a polynomial from a(n arbitrary) set of (Cj, Dj) pairs
 // Which polynomial, when executed for its value at Cj, will result in Dj (for all Cj values).
@@ -16,21 +21,38 @@ template<typename T>
 class Lagrange
 {
     public:
+        // Callback type for tracing the build: it is called with every Ci and its basis polynomial li.
+        typedef std::function<void(const T& Ci, const Polynomial<T>& li)> traceCallback;
+
         Lagrange<T>();
         void add(const T Ci, const T Di);
         void remove(const T Ci);
         bool get(const T Ci, T& Di) const;
 
+        // Set (or clear, with an empty function) the tracing hook of build()
+        void trace(const traceCallback& callback);
+
+        // Build the polynomial. If a pool is given, the basis polynomials and their sum are calculated in parallel.
         bool build();
+        bool build(ThreadPool& pool);
         Polynomial<T> polynomial() const;
 
     private:
-        // (Ci, Di) pairs
+        // (Ci, Di) pairs, in the order they were added
         std::vector<std::pair<T, T>> m_knownPairs;
+        // Index of every Ci in m_knownPairs, so that lookups don't need to scan the whole vector
+        std::unordered_map<T, size_t> m_pairIndex;
         bool m_built;
         bool m_checkPassed;
+        traceCallback m_trace;
 
+        bool _build(ThreadPool* pool);
+        Polynomial<T> _basis(const size_t index) const;
         void _check(const Polynomial<T>& poly);
+
+        // Run body(i) for every i in [0, count), on the pool if there is one.
+        template<typename F>
+        static void _forEach(ThreadPool* pool, const size_t count, F body);
         Polynomial<T> m_interpolated;
 };
 
@@ -38,6 +60,7 @@ template<typename T>
 Lagrange<T>::Lagrange()
 {
     this->m_knownPairs.clear();
+    this->m_pairIndex.clear();
     this->m_built = false;
     this->m_checkPassed = false;
     this->m_interpolated = Polynomial<T>();
@@ -46,19 +69,16 @@ Lagrange<T>::Lagrange()
 template<typename T>
 void Lagrange<T>::add(const T Ci, const T Di)
 {
-    // Check if the given Ci is already in the vector: if yes, remove it.
-    typename std::vector<std::pair<T, T>>::const_iterator it =
-        std::find_if(this->m_knownPairs.cbegin(), this->m_knownPairs.cend(),
-            [&Ci](const std::pair<T, T>& thisPair)
-            {
-                return thisPair.first == Ci;
-            }
-    );
+    // Check if the given Ci is already known: if yes, only its Di is overwritten.
+    typename std::unordered_map<T, size_t>::const_iterator it = this->m_pairIndex.find(Ci);
 
-    if (it != this->m_knownPairs.cend())
-        this->m_knownPairs.erase(it);
-    
-    this->m_knownPairs.push_back(std::pair<T, T>(Ci, Di));
+    if (it != this->m_pairIndex.cend())
+        this->m_knownPairs[it->second].second = Di;
+    else
+    {
+        this->m_pairIndex.insert(std::make_pair(Ci, this->m_knownPairs.size()));
+        this->m_knownPairs.push_back(std::pair<T, T>(Ci, Di));
+    }
 
     // Mark the interpolator changed
     this->m_built = false;
@@ -68,16 +88,22 @@ void Lagrange<T>::add(const T Ci, const T Di)
 template<typename T>
 void Lagrange<T>::remove(const T Ci)
 {
-    typename std::vector<std::pair<T, T>>::const_iterator it =
-        std::find_if(this->m_knownPairs.cbegin(), this->m_knownPairs.cend(),
-            [&Ci](const std::pair<T, T>& thisPair)
-            {
-                return thisPair.first == Ci;
-            }
-    );
+    typename std::unordered_map<T, size_t>::iterator it = this->m_pairIndex.find(Ci);
 
-    if (it != this->m_knownPairs.cend())
-        this->m_knownPairs.erase(it);
+    if (it != this->m_pairIndex.end())
+    {
+        // Erasing from the middle of the vector would shift (and reindex) every later pair.
+        // Instead, the last pair is moved into the hole, so only its index has to be updated.
+        size_t index = it->second;
+        this->m_pairIndex.erase(it);
+
+        if (index != this->m_knownPairs.size() - 1)
+        {
+            this->m_knownPairs[index] = this->m_knownPairs.back();
+            this->m_pairIndex[this->m_knownPairs[index].first] = index;
+        }
+        this->m_knownPairs.pop_back();
+    }
 
     // Mark the change
     this->m_built = false;
@@ -88,25 +114,24 @@ template<typename T>
 bool Lagrange<T>::get(const T Ci, T& Di) const
 {
     // Get the Di for the Ci
-    typename std::vector<std::pair<T, T>>::const_iterator it =
-        std::find_if(this->m_knownPairs.cbegin(), this->m_knownPairs.cend(),
-            [&Ci](const std::pair<T, T>& thisPair)
-            {
-                return thisPair.first == Ci;
-            }
-    );
-    
-    if (it != this->m_knownPairs.cend())
+    typename std::unordered_map<T, size_t>::const_iterator it = this->m_pairIndex.find(Ci);
+
+    if (it != this->m_pairIndex.cend())
     {
-        // Get the element pointed by the iterator and set the value to the return variable
-        std::pair<T, T> elem = (*it);
-        Di = elem.second;
+        // Get the pair pointed by the index and set the value to the return variable
+        Di = this->m_knownPairs[it->second].second;
         return true;
     }
     else
         return false;
 }
 
+template<typename T>
+void Lagrange<T>::trace(const traceCallback& callback)
+{
+    this->m_trace = callback;
+}
+
 template<typename T>
 Polynomial<T> Lagrange<T>::polynomial() const
 { // Return the copy of the encapsulated polynomial only!
@@ -118,6 +143,71 @@ Polynomial<T> Lagrange<T>::polynomial() const
 
 template<typename T>
 bool Lagrange<T>::build()
+{
+    return this->_build(nullptr);
+}
+
+template<typename T>
+bool Lagrange<T>::build(ThreadPool& pool)
+{
+    return this->_build(&pool);
+}
+
+template<typename T>
+template<typename F>
+void Lagrange<T>::_forEach(ThreadPool* pool, const size_t count, F body)
+{
+    if (pool)
+        pool->parallel_for(0, count, body);
+    else
+        for (size_t i = 0; i < count; ++i)
+            body(i);
+}
+
+template<typename T>
+Polynomial<T> Lagrange<T>::_basis(const size_t index) const
+{
+    // The basis polynomial li is the product of the "sub-polynomials" (x - Cj) / (Ci - Cj)
+    // for every j other than i.
+    T Ci = this->m_knownPairs[index].first;
+    Polynomial<T> result; // Created before the arena, so it can hold the result after the arena is gone
+
+    // Every temporary of the calculation goes to an arena of this thread, which is freed in one go at the end.
+    ArenaScope scope;
+
+    // The numerator, the product of the (x - Cj) factors, is built in a dense buffer: multiplying by (x - Cj)
+    // means shifting every coefficient up by one and subtracting Cj times the old coefficient.
+    // The denominator is the product of the (Ci - Cj) scalars, so it only has to be divided once at the end.
+    CoefficientBuffer<T> numerator(1, id_multiplicative<T>::value);
+    numerator.reserve(this->m_knownPairs.size());
+    T denominator = id_multiplicative<T>::value;
+
+    for (typename std::vector<std::pair<T, T>>::const_iterator inner = this->m_knownPairs.cbegin();
+        inner != this->m_knownPairs.cend(); ++inner)
+    {
+        T Cj = (*inner).first;
+        if (Cj == Ci) continue; // Always skip the current member
+
+        // numerator * (x - Cj): going from the top, so that every coefficient is only read before it's overwritten.
+        numerator.push_back(numerator.back());
+        for (size_t k = numerator.size() - 2; k > 0; --k)
+            numerator[k] = numerator[k - 1] - Cj * numerator[k];
+        numerator[0] = id_additive<T>::value - Cj * numerator[0];
+        POLYNOM_COUNT(multiplications, numerator.size() - 1);
+        POLYNOM_COUNT(additions, numerator.size() - 1);
+
+        denominator = denominator * (Ci - Cj);
+    }
+
+    Polynomial<T> li(numerator.cbegin(), numerator.cend());
+    li.divideScalar(denominator);
+
+    result = li;
+    return result;
+}
+
+template<typename T>
+bool Lagrange<T>::_build(ThreadPool* pool)
 {
     // Don't do anything if the polynomial was already built to conserve processing power
     if (this->m_built)
@@ -130,52 +220,63 @@ bool Lagrange<T>::build()
     //
     // 2) After each of the polynomials are created, we create the full polynomial as the sum of
     //    Di * li for each (Ci, Di) pair.
+    //
+    // Every li is independent of the others, so if a pool is given, they are built in parallel.
+    // The sum is then calculated as a tree: in each round, every second term is added to its left neighbour.
+    //
+    //    t0   t1   t2   t3   t4
+    //     \   /     \   /    |
+    //    t0+t1     t2+t3    t4
+    //        \     /         |
+    //       t0+...+t3       t4
+    //
+    // The additions of a round are independent too, and the shape of the tree only depends on N,
+    // so the result is the same (even for floating-point types) no matter how many threads are used.
+    const size_t count = this->m_knownPairs.size();
+    std::vector<Polynomial<T>> terms(count);
 
-    Polynomial<T> full;
-
-    for (typename std::vector<std::pair<T, T>>::const_iterator it = this->m_knownPairs.cbegin();
-        it != this->m_knownPairs.cend(); ++it)
     {
-        T Ci = (*it).first;
-        Polynomial<T> li(id_multiplicative<T>::value); // Make the polynomial default for multiplication
-
-        // Create the sub-polynomials for the current index.
-        for (typename std::vector<std::pair<T, T>>::const_iterator inner = this->m_knownPairs.cbegin();
-            inner != this->m_knownPairs.cend(); ++inner)
+        POLYNOM_PHASE("lagrange.basis");
+        this->_forEach(pool, count, [this, &terms](size_t i)
         {
-            T Cj = (*inner).first;
-            if (Cj == Ci) continue; // Always skip the current member
-            Polynomial<T> li_sub_numerator, li_sub_denominator;
+            terms[i] = this->_basis(i);
+        });
+    }
 
-            /*std::cout << "x - " << Cj << " / " << Ci << " - " << Cj << std::endl;*/
-            // Create the numerator (x - Cj)
-            li_sub_numerator.setMember(1, id_multiplicative<T>::value); // 1x
-            li_sub_numerator.subtract(Polynomial<T>(Cj)); // - Cj
+    // Report the basis polynomials (in order, on the calling thread) if someone is interested in them
+    if (this->m_trace)
+        for (size_t i = 0; i < count; ++i)
+            this->m_trace(this->m_knownPairs[i].first, terms[i]);
 
-            // Create the denominator (Ci - Cj)
-            li_sub_denominator.setMember(0, Ci - Cj);
+    {
+        POLYNOM_PHASE("lagrange.sum");
+        // Turn every li into Di * li.
+        this->_forEach(pool, count, [this, &terms](size_t i)
+        {
+            terms[i].multiplyScalar(this->m_knownPairs[i].second);
+        });
 
-            /*std::cout << li_sub_numerator << "/" << li_sub_denominator << std::endl;
-            std::cout << std::endl;*/
+        for (size_t stride = 1; stride < count; stride *= 2)
+        {
+            // In this round, terms[k * 2 * stride] absorbs terms[k * 2 * stride + stride]
+            size_t pairs = (count - stride + 2 * stride - 1) / (2 * stride);
 
-            // Multiply the polynomial to li
-            Polynomial<T> li_sub = li_sub_numerator / li_sub_denominator;
-            li.multiply(li_sub);
+            this->_forEach(pool, pairs, [&terms, stride](size_t k)
+            {
+                terms[k * 2 * stride].add(terms[k * 2 * stride + stride]);
+            });
         }
+    }
 
-        std::cout << "l" << Ci << " = " <<  li << std::endl;
-        std::cout << std::endl;
+    Polynomial<T> full;
+    if (count != 0)
+        full = terms[0];
 
-        // Add Di * li to the full polynomial.
-        T Di = (*it).second;
-        Polynomial<T> mult = Polynomial<T>(Di) * li;
-        full.add(mult);
-    }
-    /*std::cout << full << std::endl;*/
     this->m_built = true;
     this->m_checkPassed = false;
 
     // Check the polynomial if its good.
+    POLYNOM_PHASE("lagrange.check");
     this->_check(full);
 
     if (this->m_checkPassed)
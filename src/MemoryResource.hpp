@@ -0,0 +1,266 @@
+#ifndef _MEMORY_RESOURCE_H
+#define _MEMORY_RESOURCE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include "Instrumentation.hpp"
+
+// Memory resources, modelled after C++17's std::pmr, but usable with C++11.
+//
+// A memory resource is an object which hands out (and takes back) raw memory. Polynomials allocate their
+// storage through the resource which was current on their thread when they were created. By default this
+// is the heap, but an ArenaScope object can replace it with a monotonic arena for its lifetime:
+//
+//     {
+//         ArenaScope scope;       // Every polynomial created on this thread from now on uses the arena...
+//         a.divide(b, q, r);      // ... so the temporaries of the division do not go to malloc.
+//     }                           // The whole arena is freed in one go here.
+//
+// Polynomials created inside the scope must not outlive it. Results can be assigned to polynomials which
+// were created before the scope: assignment copies the coefficients into the target's own memory.
+
+class MemoryResource
+{
+    public:
+        virtual ~MemoryResource() {}
+
+        virtual void* allocate(const size_t bytes, const size_t alignment) = 0;
+        virtual void deallocate(void* memory, const size_t bytes, const size_t alignment) = 0;
+
+        // The resource using the global new and delete
+        static MemoryResource* heap();
+
+        // The resource new polynomials (and containers using ResourceAllocator) use on the current thread
+        static MemoryResource* current();
+        static void setCurrent(MemoryResource* resource);
+
+    private:
+        static MemoryResource*& _current();
+};
+
+class HeapResource : public MemoryResource
+{
+    public:
+        void* allocate(const size_t bytes, const size_t /* alignment */)
+        {
+            return ::operator new(bytes);
+        }
+
+        void deallocate(void* memory, const size_t /* bytes */, const size_t /* alignment */)
+        {
+            ::operator delete(memory);
+        }
+};
+
+MemoryResource* MemoryResource::heap()
+{
+    static HeapResource resource;
+    return &resource;
+}
+
+MemoryResource*& MemoryResource::_current()
+{
+    static thread_local MemoryResource* current = MemoryResource::heap();
+    return current;
+}
+
+MemoryResource* MemoryResource::current()
+{
+    return MemoryResource::_current();
+}
+
+void MemoryResource::setCurrent(MemoryResource* resource)
+{
+    MemoryResource::_current() = (resource ? resource : MemoryResource::heap());
+}
+
+// A monotonic arena: memory is carved from big blocks one after the other, and freeing is a no-op.
+// Every block is given back at once when the arena is released (or destructed).
+//
+// Allocation is guarded by a lock, so objects using the arena may be modified from other threads too.
+// (The lock is uncontended when everything happens on one thread, which is the intended use.)
+class MonotonicArena : public MemoryResource
+{
+    public:
+        MonotonicArena(const size_t initialBlockSize = 4096);
+        ~MonotonicArena();
+
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator = (const MonotonicArena&) = delete;
+
+        void* allocate(const size_t bytes, const size_t alignment);
+        void deallocate(void* memory, const size_t bytes, const size_t alignment);
+
+        // Give back every block to the heap
+        void release();
+
+        // The number of bytes handed out since the last release
+        size_t allocated() const;
+
+    private:
+        std::vector<void*> m_blocks;
+        char* m_current;
+        size_t m_remaining;
+        size_t m_nextBlockSize;
+        size_t m_allocated;
+        std::mutex m_mutex;
+};
+
+MonotonicArena::MonotonicArena(const size_t initialBlockSize)
+{
+    this->m_current = nullptr;
+    this->m_remaining = 0;
+    this->m_nextBlockSize = std::max(initialBlockSize, (size_t)64);
+    this->m_allocated = 0;
+}
+
+MonotonicArena::~MonotonicArena()
+{
+    this->release();
+}
+
+void* MonotonicArena::allocate(const size_t bytes, const size_t alignment)
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+
+    // Skip the bytes needed to align the current position
+    size_t padding = (alignment - reinterpret_cast<size_t>(this->m_current) % alignment) % alignment;
+
+    if (!this->m_current || padding + bytes > this->m_remaining)
+    {
+        // Start a new block: the blocks grow geometrically, so the number of mallocs is logarithmic.
+        size_t blockSize = std::max(this->m_nextBlockSize, bytes + alignment);
+        this->m_nextBlockSize *= 2;
+
+        this->m_current = static_cast<char*>(::operator new(blockSize));
+        this->m_blocks.push_back(this->m_current);
+        this->m_remaining = blockSize;
+        padding = (alignment - reinterpret_cast<size_t>(this->m_current) % alignment) % alignment;
+    }
+
+    char* memory = this->m_current + padding;
+    this->m_current = memory + bytes;
+    this->m_remaining -= padding + bytes;
+    this->m_allocated += bytes;
+
+    return memory;
+}
+
+void MonotonicArena::deallocate(void* /* memory */, const size_t /* bytes */, const size_t /* alignment */)
+{
+    // Noop. The memory is only given back when the whole arena is released.
+}
+
+void MonotonicArena::release()
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+
+    for (std::vector<void*>::const_iterator cit = this->m_blocks.cbegin(); cit != this->m_blocks.cend(); ++cit)
+        ::operator delete(*cit);
+
+    this->m_blocks.clear();
+    this->m_current = nullptr;
+    this->m_remaining = 0;
+    this->m_allocated = 0;
+}
+
+size_t MonotonicArena::allocated() const
+{
+    return this->m_allocated;
+}
+
+// Make an arena the current resource of this thread while the object lives.
+// Scopes can be nested: the previous resource is restored when the scope ends.
+class ArenaScope
+{
+    public:
+        ArenaScope(const size_t initialBlockSize = 4096) : m_arena(initialBlockSize)
+        {
+            this->m_previous = MemoryResource::current();
+            MemoryResource::setCurrent(&this->m_arena);
+        }
+
+        ~ArenaScope()
+        {
+            MemoryResource::setCurrent(this->m_previous);
+        }
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator = (const ArenaScope&) = delete;
+
+        MonotonicArena& arena()
+        {
+            return this->m_arena;
+        }
+
+    private:
+        MonotonicArena m_arena;
+        MemoryResource* m_previous;
+};
+
+// Standard allocator which gets its memory from a resource. A default-constructed allocator uses the current
+// resource of the thread. Copies of a container do not inherit the resource (they get the current one),
+// and assignment never replaces the target's resource: so memory from a short-lived arena can't leak into
+// long-lived containers through copying and moving.
+template<typename U>
+class ResourceAllocator
+{
+    public:
+        typedef U value_type;
+        typedef std::false_type propagate_on_container_copy_assignment;
+        typedef std::false_type propagate_on_container_move_assignment;
+        typedef std::false_type propagate_on_container_swap;
+
+        ResourceAllocator() : m_resource(MemoryResource::current()) {}
+        ResourceAllocator(MemoryResource* resource) : m_resource(resource) {}
+
+        template<typename V>
+        ResourceAllocator(const ResourceAllocator<V>& other) : m_resource(other.resource()) {}
+
+        U* allocate(const size_t n)
+        {
+            POLYNOM_COUNT(allocations, 1);
+            POLYNOM_COUNT(allocatedBytes, n * sizeof(U));
+            return static_cast<U*>(this->m_resource->allocate(n * sizeof(U), alignof(U)));
+        }
+
+        void deallocate(U* memory, const size_t n)
+        {
+            this->m_resource->deallocate(memory, n * sizeof(U), alignof(U));
+        }
+
+        ResourceAllocator<U> select_on_container_copy_construction() const
+        {
+            return ResourceAllocator<U>();
+        }
+
+        MemoryResource* resource() const
+        {
+            return this->m_resource;
+        }
+
+    private:
+        MemoryResource* m_resource;
+};
+
+template<typename U, typename V>
+bool operator == (const ResourceAllocator<U>& a, const ResourceAllocator<V>& b)
+{
+    return a.resource() == b.resource();
+}
+
+template<typename U, typename V>
+bool operator != (const ResourceAllocator<U>& a, const ResourceAllocator<V>& b)
+{
+    return a.resource() != b.resource();
+}
+
+// Dense coefficient buffers of the polynomial algorithms
+template<typename T>
+using CoefficientBuffer = std::vector<T, ResourceAllocator<T>>;
+
+#endif // _MEMORY_RESOURCE_H
@@ -0,0 +1,142 @@
+#ifndef _PARALLEL_MULTIPLICATION_H
+#define _PARALLEL_MULTIPLICATION_H
+
+#include <algorithm>
+#include <cstddef>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "SimdKernels.hpp"
+#include "Thresholds.hpp"
+#include "ThreadPool.hpp"
+
+// Multiplication of long polynomials on the threads of a pool.
+//
+// The work is split the same way as the sequential multiplication (see DenseMultiplication.hpp) splits it:
+// the three half-sized products of a Karatsuba step are calculated in parallel (and so are theirs, recursively,
+// until the operands are shorter than PARALLEL_MULTIPLICATION_THRESHOLD), so the parallel version does exactly
+// the same operations. The slices of unbalanced operands are multiplied in two rounds, the even ones first, then
+// the odd ones, because neighbouring slices add to the same coefficients of the result.
+//
+// The results are the same no matter how many threads the pool has. For floating-point types they might differ
+// from the sequential product in the last bits, as the odd slices are added in a different order.
+
+// result[0 .. n+m-2] += a[0 .. n-1] * b[0 .. m-1]
+template<typename T>
+void parallel_dense_multiply_add(const T* a, const size_t n, const T* b, const size_t m, T* result, ThreadPool& pool)
+{
+    if (n == 0 || m == 0)
+        return;
+
+    // Make a the longer operand
+    if (n < m)
+    {
+        parallel_dense_multiply_add(b, m, a, n, result, pool);
+        return;
+    }
+
+    const size_t karatsuba = algorithm_thresholds<T>::karatsuba;
+    const size_t parallel = algorithm_thresholds<T>::parallelMultiplication;
+    if (m < parallel || m < karatsuba || m < 2)
+    {
+        // A long operand is still cut into slices which the threads can work on, even if the other one is short
+        // (of a fixed length, not depending on the number of threads, so the results don't either)
+        const size_t slice = std::max(m, parallel);
+        if (n < 2 * slice || n * m < parallel * parallel)
+        {
+            dense_multiply_add(a, n, b, m, result);
+            return;
+        }
+
+        const size_t slices = (n + slice - 1) / slice;
+        for (size_t round = 0; round < 2; ++round)
+            pool.parallel_for(0, (slices + 1 - round) / 2, [a, n, b, m, result, slice, round](size_t k)
+            {
+                const size_t offset = (2 * k + round) * slice;
+                dense_multiply_add(a + offset, std::min(slice, n - offset), b, m, result + offset);
+            });
+    }
+    else if (n > m)
+    {
+        // Unbalanced operands: the m long slices of a, every product is balanced
+        const size_t slices = (n + m - 1) / m;
+        for (size_t round = 0; round < 2; ++round)
+            pool.parallel_for(0, (slices + 1 - round) / 2, [a, n, b, m, result, round, &pool](size_t k)
+            {
+                const size_t offset = (2 * k + round) * m;
+                parallel_dense_multiply_add(a + offset, std::min(m, n - offset), b, m, result + offset, pool);
+            });
+    }
+    else
+    {
+        // Both are n long: a = a0 + a1*x^h, b = b0 + b1*x^h, with a0 and b0 being h long
+        const size_t h = n / 2;
+        const size_t high = n - h;
+
+        CoefficientBuffer<T> sums(2 * high, id_additive<T>::value);
+        for (size_t i = 0; i < high; ++i)
+        {
+            sums[i] = (i < h ? a[i] + a[h + i] : a[h + i]);
+            sums[high + i] = (i < h ? b[i] + b[h + i] : b[h + i]);
+        }
+
+        CoefficientBuffer<T> low(2 * h - 1, id_additive<T>::value);
+        CoefficientBuffer<T> top(2 * high - 1, id_additive<T>::value);
+        CoefficientBuffer<T> middle(2 * high - 1, id_additive<T>::value);
+
+        // The three products are independent
+        pool.parallel_for(0, 3, [a, b, h, high, &sums, &low, &top, &middle, &pool](size_t product)
+        {
+            if (product == 0)
+                parallel_dense_multiply_add(a, h, b, h, low.data(), pool);
+            else if (product == 1)
+                parallel_dense_multiply_add(a + h, high, b + h, high, top.data(), pool);
+            else
+                parallel_dense_multiply_add(sums.data(), high, sums.data() + high, high, middle.data(), pool);
+        });
+
+        simd_add(result, low.data(), result, low.size());
+        simd_subtract(middle.data(), low.data(), middle.data(), low.size());
+        simd_add(result + 2 * h, top.data(), result + 2 * h, top.size());
+        simd_subtract(middle.data(), top.data(), middle.data(), top.size());
+        simd_add(result + h, middle.data(), result + h, middle.size());
+
+        POLYNOM_COUNT(additions, 2 * h);
+    }
+}
+
+// result = a * b
+template<typename T>
+void parallel_dense_multiply(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, CoefficientBuffer<T>& result,
+    ThreadPool& pool)
+{
+    POLYNOM_PHASE("multiply");
+    result.assign(a.empty() || b.empty() ? 0 : a.size() + b.size() - 1, id_additive<T>::value);
+    parallel_dense_multiply_add(a.data(), a.size(), b.data(), b.size(), result.data(), pool);
+}
+
+/* The same on polynomials */
+// a * b
+template<typename T>
+Polynomial<T> parallel_multiply(const Polynomial<T>& a, const Polynomial<T>& b, ThreadPool& pool)
+{
+    // Short polynomials, monomials and constants don't need the threads
+    if (std::min(a.degree(), b.degree()) < algorithm_thresholds<T>::karatsuba || a.isMonomial() || b.isMonomial())
+        return a * b;
+
+    CoefficientBuffer<T> lefts, rights, result;
+    a.getCoefficients(lefts);
+    b.getCoefficients(rights);
+    parallel_dense_multiply(lefts, rights, result, pool);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// a * b on the shared pool
+template<typename T>
+Polynomial<T> parallel_multiply(const Polynomial<T>& a, const Polynomial<T>& b)
+{
+    return parallel_multiply(a, b, ThreadPool::shared());
+}
+
+#endif // _PARALLEL_MULTIPLICATION_H
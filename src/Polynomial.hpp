@@ -8,34 +8,83 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <limits>
 #include "absvalue_wrapper.hpp"
 #include "add_mult_identity.hpp"
+#include "Instrumentation.hpp"
+#include "MemoryResource.hpp"
+#include "DenseMultiplication.hpp"
+
+// Helper to keep the scalar argument of an operator out of the template argument deduction,
+// so that poly / 2 works for a Polynomial<double> too.
+template<typename T>
+struct polynomial_scalar
+{
+    typedef T type;
+};
+
+// Expression templates (see PolynomialExpression.hpp)
+template<typename T, typename E> class PolynomialExpression;
+template<typename T> class PolynomialTerm;
+
+// Binary serialisation (see Serialisation.hpp)
+template<typename T> struct polynomial_serialiser;
 
 template<typename T>
 class Polynomial
 {
-    typedef std::map<size_t, T, std::greater<size_t> > coefficientsMap;
+    typedef std::map<size_t, T, std::greater<size_t>, ResourceAllocator<std::pair<const size_t, T>> > coefficientsMap;
+    friend class PolynomialTerm<T>;
+    friend struct threshold_tuning<T>;
+    friend struct polynomial_serialiser<T>;
 
     public:
         /* Constructors */
         // Default constructor
+        // (The polynomial allocates its members from the current memory resource of the thread.)
         Polynomial<T>();
 
+        // Create a nullpolynomial which allocates its members from the given memory resource
+        Polynomial<T>(MemoryResource& resource);
+
         // Constructors for constant polynomials
         Polynomial<T>(T coefficient);
 
         // Default constructor with initial coefficient length provided
         //Polynomial<T>(const size_t coefficients);
 
+        // Construct from a range of coefficients, the first one being the constant member's
+        // (so the range { -9, 4, 3 } creates 3x^2 + 4x - 9). The polynomial is normalised only once.
+        template<typename InputIterator>
+        Polynomial<T>(InputIterator first, InputIterator last);
+
         // Copy constructor from another polynom
         Polynomial<T>(const Polynomial<T>& poly);
 
+        // Move constructor, the moved-from polynomial becomes a nullpolynomial
+        Polynomial<T>(Polynomial<T>&& poly) noexcept;
+
+        // Construct as the value of an expression
+        template<typename E>
+        Polynomial<T>(const PolynomialExpression<T, E>& expression);
+
         /* Destructor */
         ~Polynomial<T>();
 
         /* Operators */
         // Assignment operator
         const Polynomial<T>& operator = (const Polynomial<T>& poly);
+        const Polynomial<T>& operator = (Polynomial<T>&& poly);
+        template<typename E>
+        const Polynomial<T>& operator = (const PolynomialExpression<T, E>& expression);
+
+        // Compound assignment operators
+        const Polynomial<T>& operator += (const Polynomial<T>& poly);
+        const Polynomial<T>& operator -= (const Polynomial<T>& poly);
+        template<typename E>
+        const Polynomial<T>& operator += (const PolynomialExpression<T, E>& expression);
+        template<typename E>
+        const Polynomial<T>& operator -= (const PolynomialExpression<T, E>& expression);
 
         // Subscript getter operator to get an nth coefficient
         T operator [] (const size_t index) const;
@@ -43,18 +92,52 @@ class Polynomial
         T& operator [] (const size_t index);*/
 
         // Arithmetic operators
+        // (The overloads taking temporaries calculate the result in the temporary's storage.)
         template<typename U>
         friend Polynomial<U> operator + (const Polynomial<U>& a, const Polynomial<U>& b);
         template<typename U>
+        friend Polynomial<U> operator + (Polynomial<U>&& a, const Polynomial<U>& b);
+        template<typename U>
+        friend Polynomial<U> operator + (const Polynomial<U>& a, Polynomial<U>&& b);
+        template<typename U>
+        friend Polynomial<U> operator + (Polynomial<U>&& a, Polynomial<U>&& b);
+        template<typename U>
         friend Polynomial<U> operator - (const Polynomial<U>& a, const Polynomial<U>& b);
+        template<typename U>
+        friend Polynomial<U> operator - (Polynomial<U>&& a, const Polynomial<U>& b);
+        template<typename U>
+        friend Polynomial<U> operator - (Polynomial<U>&& a, Polynomial<U>&& b);
 
         template<typename U>
         friend Polynomial<U> operator * (const Polynomial<U>& a, const Polynomial<U>& b);
+        template<typename U>
+        friend Polynomial<U> operator * (Polynomial<U>&& a, const Polynomial<U>& b);
+        template<typename U>
+        friend Polynomial<U> operator * (Polynomial<U>&& a, Polynomial<U>&& b);
 
         template<typename U>
         friend Polynomial<U> operator / (const Polynomial<U>& a, const Polynomial<U>& b);
         template<typename U>
+        friend Polynomial<U> operator / (Polynomial<U>&& a, const Polynomial<U>& b);
+        template<typename U>
         friend Polynomial<U> operator % (const Polynomial<U>& a, const Polynomial<U>& b);
+        template<typename U>
+        friend Polynomial<U> operator % (Polynomial<U>&& a, const Polynomial<U>& b);
+
+        // Multiplication and division by a scalar multiply or divide every coefficient.
+        // (For a fused a + c*b - d, see scaled() in PolynomialExpression.hpp)
+        template<typename U>
+        friend Polynomial<U> operator * (const Polynomial<U>& a, const typename polynomial_scalar<U>::type& c);
+        template<typename U>
+        friend Polynomial<U> operator * (Polynomial<U>&& a, const typename polynomial_scalar<U>::type& c);
+        template<typename U>
+        friend Polynomial<U> operator * (const typename polynomial_scalar<U>::type& c, const Polynomial<U>& a);
+        template<typename U>
+        friend Polynomial<U> operator * (const typename polynomial_scalar<U>::type& c, Polynomial<U>&& a);
+        template<typename U>
+        friend Polynomial<U> operator / (const Polynomial<U>& a, const typename polynomial_scalar<U>::type& c);
+        template<typename U>
+        friend Polynomial<U> operator / (Polynomial<U>&& a, const typename polynomial_scalar<U>::type& c);
 
         // qualit, inqualit
         template<typename U>
@@ -81,6 +164,9 @@ class Polynomial
         // Get the degree
         size_t degree() const;
 
+        // Get the memory resource the polynomial allocates from
+        MemoryResource* resource() const;
+
         // Get the leading coefficient (shortcut to the degree-th member's)
         T leadingCoefficient() const
         {
@@ -93,6 +179,10 @@ class Polynomial
         // Set the nth coefficient
         void setMember(const size_t index, const T coefficient);
 
+        // Get every coefficient densely: the ith element of the buffer is the coefficient of x^i.
+        // (The range constructor does the opposite.)
+        void getCoefficients(CoefficientBuffer<T>& coefficients) const;
+
         // Calculate the polynomial function's value for variable 't'
         T at(const T t) const;
 
@@ -105,6 +195,12 @@ class Polynomial
         void multiply(const Polynomial<T>& poly);
         bool divide(const Polynomial<T>& divisor, Polynomial<T>& quotient, Polynomial<T>& remainder) const;
 
+        // Arithmetics with scalars (and monomials), in one pass over the members without creating temporaries
+        void multiplyScalar(const T& factor);
+        void divideScalar(const T& divisor);
+        // Multiply by the monomial coefficient * x^power
+        void multiplyMonomial(const size_t power, const T& coefficient);
+
         // Equalit
         bool equals(const Polynomial<T>& poly) const;
 
@@ -115,6 +211,9 @@ class Polynomial
         // (that is: a number... only one coefficient on the zeroth power, and it is not zero)
         bool isConstant() const;
 
+        // Get if the polynomial is a monomial (that is: it has exactly one non-zero member, like 3x^5)
+        bool isMonomial() const;
+
     private:
         // Array for coefficients
         // (First part of the pair is the power of the indeterminate,
@@ -127,24 +226,60 @@ class Polynomial
         // Determine if there is an indeterminate of the given power index
         bool hasMember(const size_t index) const;
 
-        // Internal cleanup function.
+        // Internal cleanup function: remove the zero coefficients and recalculate the degree with one pass over the map.
         void _performCleanup();
+
+        // Get the coefficients densely (the vector's ith element is the ith coefficient) and set them back.
+        void _getDense(CoefficientBuffer<T>& coefficients) const;
+        void _setDense(const CoefficientBuffer<T>& coefficients);
+
+        // Add to (or subtract from) the index-th coefficient, keeping the invariant
+        void _addToMember(const size_t index, const T& coefficient, const bool subtract);
+
+        // Subtract poly * factor * x^shift, given that it cancels the leading member of this polynomial
+        void _subtractLeading(const Polynomial<T>& poly, const size_t shift, const T& factor);
+
+        // Polynomial long division which consumes the dividend: when it returns, the dividend is the remainder.
+        // (It's done on dense buffers if the divisor is dense enough, see DENSE_DIVISION_THRESHOLD.)
+        static void _longDivision(Polynomial<T>& dividend, const Polynomial<T>& divisor, Polynomial<T>& quotient,
+            const size_t denseDivision = algorithm_thresholds<T>::denseDivision);
+
+        // The same on dense buffers, for dense divisors of types which are not integers
+        static void _denseLongDivision(Polynomial<T>& dividend, const Polynomial<T>& divisor, Polynomial<T>& quotient);
 };
 
 template<typename T>
 Polynomial<T>::Polynomial()
 {
     //cout << "Polynomial initialized." << endl;
-    this->_performCleanup(); // Make the object into default state
-    //cout << "Polynomial initialized." << endl;
-    // Noop.
+    this->m_degree = 0; // Make the object into default state
 }
 
 template<typename T>
 Polynomial<T>::Polynomial(T coefficient)
 {
     //cout << "Polynomial initialized as constant " << coefficient << endl;
+    this->m_degree = 0;
     this->setMember(0, coefficient);
+}
+
+template<typename T>
+Polynomial<T>::Polynomial(MemoryResource& resource)
+    : m_coefficients(std::greater<size_t>(), ResourceAllocator<std::pair<const size_t, T>>(&resource))
+{
+    this->m_degree = 0;
+}
+
+template<typename T>
+template<typename InputIterator>
+Polynomial<T>::Polynomial(InputIterator first, InputIterator last)
+{
+    // The map is ordered by descending power, so each new (higher) power goes to the front:
+    // giving the beginning as the hint makes the insertion constant time.
+    for (size_t power = 0; first != last; ++first, ++power)
+        if (*first != id_additive<T>::value)
+            this->m_coefficients.insert(this->m_coefficients.begin(), std::make_pair(power, *first));
+
     this->_performCleanup();
 }
 
@@ -159,9 +294,18 @@ template<typename T>
 Polynomial<T>::Polynomial(const Polynomial<T>& poly)
 {
     //cout << "Polynomial copied from " << poly << endl;
-    // Copy the map.
+    // Copy the map. The other polynomial already satisfies the invariant, so there is nothing to clean up.
     this->m_coefficients = poly.m_coefficients;
-    this->_performCleanup();
+    this->m_degree = poly.m_degree;
+}
+
+template<typename T>
+Polynomial<T>::Polynomial(Polynomial<T>&& poly) noexcept
+    : m_coefficients(std::move(poly.m_coefficients)), m_degree(poly.m_degree)
+{
+    // Leave the other polynomial as a valid nullpolynomial.
+    poly.m_coefficients.clear();
+    poly.m_degree = 0;
 }
 
 #include <sstream>
@@ -179,7 +323,37 @@ template<typename T>
 const Polynomial<T>& Polynomial<T>::operator=(const Polynomial<T>& poly)
 {
     this->m_coefficients = poly.m_coefficients;
-    this->_performCleanup();
+    this->m_degree = poly.m_degree;
+    return *this;
+}
+
+template<typename T>
+const Polynomial<T>& Polynomial<T>::operator=(Polynomial<T>&& poly)
+{
+    // If the two polynomials use different memory resources, the map moves the members one by one
+    // into this polynomial's own resource. (That's why this might throw.)
+    if (this != &poly)
+    {
+        this->m_coefficients = std::move(poly.m_coefficients);
+        this->m_degree = poly.m_degree;
+
+        poly.m_coefficients.clear();
+        poly.m_degree = 0;
+    }
+    return *this;
+}
+
+template<typename T>
+const Polynomial<T>& Polynomial<T>::operator+=(const Polynomial<T>& poly)
+{
+    this->add(poly);
+    return *this;
+}
+
+template<typename T>
+const Polynomial<T>& Polynomial<T>::operator-=(const Polynomial<T>& poly)
+{
+    this->subtract(poly);
     return *this;
 }
 
@@ -272,11 +446,18 @@ size_t Polynomial<T>::degree() const
     return this->m_degree;
 }
 
+template<typename T>
+MemoryResource* Polynomial<T>::resource() const
+{
+    return this->m_coefficients.get_allocator().resource();
+}
+
 template<typename T>
 T Polynomial<T>::getMember(const size_t index) const
 {
-    if (this->hasMember(index))
-        return this->m_coefficients.at(index);
+    typename Polynomial<T>::coefficientsMap::const_iterator cit = this->m_coefficients.find(index);
+    if (cit != this->m_coefficients.cend())
+        return cit->second;
     else
         return id_additive<T>::value; // Non-existant members are just not stored: they are mathematically there with 0 coefficient.
 }
@@ -284,8 +465,27 @@ T Polynomial<T>::getMember(const size_t index) const
 template<typename T>
 void Polynomial<T>::setMember(const size_t index, const T coefficient)
 {
-    this->m_coefficients[index] = coefficient; // Add or reassign a member
-    this->_performCleanup();
+    // Only the touched member has to be normalised: the rest of the polynomial already satisfies the invariant.
+    if (coefficient == id_additive<T>::value)
+    {
+        // Zero coefficients are not stored, so setting one is removing the member
+        typename Polynomial<T>::coefficientsMap::iterator it = this->m_coefficients.find(index);
+        if (it == this->m_coefficients.end())
+            return;
+
+        this->m_coefficients.erase(it);
+
+        // If the leading member was removed, the next one (the first in the descending map) leads
+        if (index == this->m_degree)
+            this->m_degree = (this->m_coefficients.empty() ? 0 : this->m_coefficients.begin()->first);
+    }
+    else
+    {
+        this->m_coefficients[index] = coefficient; // Add or reassign a member
+
+        if (index > this->m_degree)
+            this->m_degree = index;
+    }
 }
 
 template<typename T>
@@ -308,6 +508,9 @@ T Polynomial<T>::at(const T t) const
     for (size_t power = this->degree() - 1; power >= 0 && power <= this->degree(); --power)
         result = result * t + this->getMember(power);
 
+    POLYNOM_COUNT(multiplications, this->degree());
+    POLYNOM_COUNT(additions, this->degree());
+
     return result;
 }
 
@@ -320,24 +523,24 @@ Polynomial<T> Polynomial<T>::derive() const
     // If we consider the polynomial as f0 + f1x + f2x^2 + ..., the
     //  algebraic derivative (prime) is f1 + 2*f2x + 3*f3x^2 + ...
     // (Where 2*f2 actually means f2 + f2, as f2 is just a variable of type T)
-    Polynomial<T> derivative;
-    for (size_t power = 0; power < this->degree(); ++power)
+    CoefficientBuffer<T> coefficients(this->degree(), id_additive<T>::value);
+    for (typename Polynomial<T>::coefficientsMap::const_iterator cit = this->m_coefficients.cbegin();
+        cit != this->m_coefficients.cend(); ++cit)
     {
-        // The i-th coefficient of the derivate is (i + 1)* the (i+1)th coefficient
-        T curr_coeff = this->getMember(power + 1);
-
-        // Don't run the loop for coefficients which are 0
-        if (curr_coeff == id_additive<T>::value) continue;
-
-        for (size_t i = 1; i < power + 1; ++i)
-            curr_coeff += this->getMember(power + 1);
+        // The constant part is eaten by the prime.
+        if (cit->first == 0) continue;
 
-        derivative.setMember(power, curr_coeff);
+        // The i-th coefficient of the derivate is (i + 1)* the (i+1)th coefficient
+        T curr_coeff = cit->second;
+        for (size_t i = 1; i < cit->first; ++i)
+            curr_coeff += cit->second;
+        POLYNOM_COUNT(additions, cit->first - 1);
 
-        // The coefficient for the degree-th member is zero, the prime "eats" that part.
-        // Also, the constant part is eaten too.
+        coefficients[cit->first - 1] = curr_coeff;
     }
 
+    Polynomial<T> derivative;
+    derivative._setDense(coefficients);
     return derivative;
 }
 
@@ -349,18 +552,36 @@ void Polynomial<T>::add(const Polynomial<T>& poly)
     // ----------------------
     //     x^3 +3x^2 +  x - 1
     //
-    // So we have to member-by-member add the coefficients to get the added polynomial
+    // So we have to member-by-member add the coefficients to get the added polynomial.
+    // Only the members which exist in the other polynomial change, the rest is added 0.
 
-    for (size_t p = 0; p <= std::max(this->degree(), poly.degree()); ++p)
-        this->setMember(p, this->getMember(p) + poly.getMember(p));
+    if (&poly == this)
+    {
+        // Adding to itself would change the map we iterate over.
+        Polynomial<T> copy(poly);
+        this->add(copy);
+        return;
+    }
+
+    for (typename Polynomial<T>::coefficientsMap::const_iterator cit = poly.m_coefficients.cbegin();
+        cit != poly.m_coefficients.cend(); ++cit)
+        this->_addToMember(cit->first, cit->second, false);
 }
 
 template<typename T>
 void Polynomial<T>::subtract(const Polynomial<T>& poly)
 {
     // Subtraction works just as so
-    for (size_t p = 0; p <= std::max(this->degree(), poly.degree()); ++p)
-        this->setMember(p, this->getMember(p) - poly.getMember(p));
+    if (&poly == this)
+    {
+        Polynomial<T> copy(poly);
+        this->subtract(copy);
+        return;
+    }
+
+    for (typename Polynomial<T>::coefficientsMap::const_iterator cit = poly.m_coefficients.cbegin();
+        cit != poly.m_coefficients.cend(); ++cit)
+        this->_addToMember(cit->first, cit->second, true);
 }
 
 template<typename T>
@@ -368,61 +589,37 @@ void Polynomial<T>::multiply(const Polynomial<T>& poly)
 {
     // If either is a nullpolynomial, the multiple is trivially a nullpolynomial
     if (this->isNull() || poly.isNull())
-        this->m_coefficients.clear();
-    // If both is a constant, the multiple is trivially the constants' multiple
-    else if (this->isConstant() && poly.isConstant())
     {
-        T multiple = this->leadingCoefficient() * poly.leadingCoefficient();
-
         this->m_coefficients.clear();
-        this->setMember(0, multiple);
+        this->m_degree = 0;
     }
-    // If either polynomials is a constant one (but not both), we can still ease the multiplication
-    else if (this->isConstant() || poly.isConstant())
+    // If the other polynomial is a constant or a monomial, only our coefficients have to be multiplied (and shifted)
+    else if (poly.isMonomial())
+        this->multiplyMonomial(poly.degree(), poly.leadingCoefficient());
+    // If we are the constant or the monomial, the same goes for the other polynomial's coefficients
+    else if (this->isMonomial())
     {
-        // Select which polynomial is the constant and the more complex one;
-        const Polynomial* constantOne = (this->isConstant() ? this : &poly);
-        const Polynomial* complexOne = (!this->isConstant() ? this : &poly);
-        Polynomial<T> multiple;
-
-        // Only multiply the coefficients of the complex polynomial by the given constant, storing it in this
-        T constant = constantOne->leadingCoefficient();
-        for (size_t i = 0; i <= complexOne->degree(); ++i)
-        {
-            T coeff = complexOne->getMember(i);
-            if (coeff == id_additive<T>::value) continue;
-
-            multiple.setMember(i, coeff * constant);
-        }
+        size_t power = this->degree();
+        T coefficient = this->leadingCoefficient();
 
-        // Let the multiplied polynomial be the current one
-        *this = multiple;
+        *this = poly;
+        this->multiplyMonomial(power, coefficient);
     }
     // If both polynomials are complex ones, we do the multiplication by hand
     else
     {
-        std::vector<T> multi_coefficients;
-        multi_coefficients.resize(this->degree() + poly.degree() + 1); // Create space for the coefficients
-
-        for (size_t i = 0; i <= this->degree(); ++i)
-        {
-            T left = this->getMember(i);
-            if (left == id_additive<T>::value) continue; // 0 * anything = 0
+        // Look up the coefficients only once instead of in every step of the loops
+        CoefficientBuffer<T> lefts, rights;
+        this->_getDense(lefts);
+        poly._getDense(rights);
 
-            for (size_t j = 0; j <= poly.degree(); ++j)
-            {
-                T right = poly.getMember(j);
-                if (right == id_additive<T>::value) continue; // anything * 0 = 0
-
-                // Basically you have to multiply every member with every member...
-                multi_coefficients.at(i+j) += left * right;
-            }
-        }
+        // Basically you have to multiply every member with every member...
+        // (or use Karatsuba's method for long polynomials, see DenseMultiplication.hpp)
+        CoefficientBuffer<T> multi_coefficients;
+        dense_multiply(lefts, rights, multi_coefficients);
 
         // Set the calculated coefficients
-        this->m_coefficients.clear();
-        for (size_t i = 0; i < multi_coefficients.size(); ++i)
-            this->setMember(i, multi_coefficients.at(i));
+        this->_setDense(multi_coefficients);
     }
 }
 
@@ -432,70 +629,112 @@ bool Polynomial<T>::divide(const Polynomial<T>& divisor, Polynomial<T>& quotient
     if (divisor.isNull())
         return false;
 
-    if (divisor.degree() > this->degree())
+    POLYNOM_PHASE("divide");
+    Polynomial<T> dividend = *this; // Save out the current instance
+    Polynomial<T>::_longDivision(dividend, divisor, quotient);
+
+    // Anything that remained in the dividend (after subtraction) is actually the remainder.
+    remainder = std::move(dividend); // So move it into its proper place.
+
+    return true;
+}
+
+template<typename T>
+void Polynomial<T>::_longDivision(Polynomial<T>& dividend, const Polynomial<T>& divisor, Polynomial<T>& quotient,
+    const size_t denseDivision)
+{
+    quotient = Polynomial<T>();
+
+    // If the degree of divisor is bigger than the dividend's, the quotient is null and the dividend is the remainder.
+    if (divisor.degree() > dividend.degree())
+        return;
+
+    // Dividing by a constant is just dividing every coefficient.
+    if (divisor.isConstant() && !std::numeric_limits<T>::is_integer)
     {
-        remainder = *this;
-        Polynomial<T> quotient_null;
-        quotient = quotient_null;
-        return true;
+        quotient = std::move(dividend);
+        quotient.divideScalar(divisor.leadingCoefficient());
+        dividend = Polynomial<T>();
+        return;
     }
-    else
+
+    // Subtracting a dense divisor is faster on a buffer than member by member in the map
+    if (!std::numeric_limits<T>::is_integer && divisor.m_coefficients.size() * denseDivision > divisor.degree())
+    {
+        Polynomial<T>::_denseLongDivision(dividend, divisor, quotient);
+        return;
+    }
+
     // Degree of divisor is smaller or equal than divident
+    // f : g = q
+    // f % g = r
+    // f: dividend (this), g: divisor, q: quotient, r: remainder
+    // The dividend is only initially 'this', it gets consumed as the division happens.
+
+    size_t quotient_max_degree = dividend.degree() - divisor.degree();
+    size_t quotient_member_degree = quotient_max_degree;
+    // We can only divide further if there is something to divide.
+    while (quotient_member_degree >= 0 && quotient_member_degree <= quotient_max_degree && !dividend.isNull())
     {
-        Polynomial dividend = *this; // Save out the current instance
-        // f : g = q
-        // f % g = r
-        // f: dividend (this), g: divisor, q: quotient, r: remainder
-        // The dividend is only initially 'this', it gets consumed as the division happens.
-
-        size_t quotient_max_degree = dividend.degree() - divisor.degree();
-        size_t quotient_member_degree = quotient_max_degree;
-        // We can only divide further if there is something to divide.
-        while (quotient_member_degree >= 0 && quotient_member_degree <= quotient_max_degree && !dividend.isNull())
-        {
-            /*cout << "-----------------------------" << endl;
-            cout << "I'm running a division loop. Current degree of the quotient: " << quotient_member_degree << endl;
-            cout << "(Maximum plausible degree of quotient: " << quotient_max_degree << ")" << endl;
-            cout << "Dividend: " << dividend << endl;*/
-            // Subtract the divisor's LC from the dividend's LC
-            // (and so the powers), so that we get the LC of the quotient.
-            /*cout << "deg(divident) = " << dividend.degree() << endl;
-            cout << "lc(dividend) = " << dividend.leadingCoefficient() << endl;*/
+        // Subtract the divisor's LC from the dividend's LC
+        // (and so the powers), so that we get the LC of the quotient.
 
-            // After subtracting the LCs, we get the quotient's LC.
-            // Using polynomial long division, we now multiply the quotient's LC by the divisor (-> getting a polynomial)
-            // and thus, we subtract that from the dividend... and loop this whole shit.)
+        // After subtracting the LCs, we get the quotient's LC.
+        // Using polynomial long division, we now multiply the quotient's LC by the divisor (-> getting a polynomial)
+        // and thus, we subtract that from the dividend... and loop this whole shit.)
 
-            // If the current member degree underflows, thus reaches a values higher than the maximum degree
-            // We terminate the whole cycle because we reached the remainder.
-            if (quotient_member_degree > quotient_max_degree)
-                break;
+        // If the current member degree underflows, thus reaches a values higher than the maximum degree
+        // We terminate the whole cycle because we reached the remainder.
+        if (quotient_member_degree > quotient_max_degree)
+            break;
 
-            // Set the current member of the quotient to the quotient of the coefficients
-            quotient.setMember(quotient_member_degree, dividend.leadingCoefficient() / divisor.leadingCoefficient());
+        // Set the current member of the quotient to the quotient of the coefficients
+        T quotient_member = dividend.leadingCoefficient() / divisor.leadingCoefficient();
 
-            Polynomial<T> multiplier;
-            multiplier.setMember(quotient_member_degree, quotient.getMember(quotient_member_degree));
+        // If the LC is not divisible by the divisor's LC (e.g. 2 / 3 with integers), the division can't go on.
+        if (quotient_member == id_additive<T>::value)
+            break;
 
-            /*cout << "Divisor: " << divisor << endl;*/
-            Polynomial<T> inner_multiple = divisor * multiplier;
+        quotient.setMember(quotient_member_degree, quotient_member);
 
-            dividend = dividend - inner_multiple;
+        // Subtract divisor * (quotient member) * x^(its degree) from the dividend, right in its place.
+        dividend._subtractLeading(divisor, quotient_member_degree, quotient_member);
 
-            /*cout << "Current quotient (across division operation): " << quotient << endl;
-            cout << "Current multiplier: " << multiplier << endl;
-            cout << "Multiplied dividend: (this will be subtracted) " << inner_multiple << endl;
-            cout << "New dividend (after subtraction): " << dividend << endl;*/
+        quotient_member_degree = dividend.degree() - divisor.degree();
+    }
 
-            quotient_member_degree = dividend.degree() - divisor.degree();
-        }
+    // When the loop reaches its terminus, we divided everything we could.
+}
+
+template<typename T>
+void Polynomial<T>::_denseLongDivision(Polynomial<T>& dividend, const Polynomial<T>& divisor, Polynomial<T>& quotient)
+{
+    CoefficientBuffer<T> remainders, divisors;
+    dividend._getDense(remainders);
+    divisor._getDense(divisors);
+
+    // The same steps as the long division in the map: each quotient member cancels the leading member exactly,
+    // and the division stops if a quotient member would be zero. (So the results are the same, even for
+    // floating-point types.)
+    const size_t length = remainders.size() - divisors.size() + 1;
+    CoefficientBuffer<T> quotients(length, id_additive<T>::value);
+    const T& leading = divisors.back();
+    for (size_t i = length; i-- > 0; )
+    {
+        T& top = remainders[i + divisors.size() - 1];
+        if (top == id_additive<T>::value) continue;
 
-        // When the loop reaches its terminus, we divided everything we could.
-        // Anything that remained in the dividend (after subtraction) is actually the remainder.
-        remainder = dividend; // So assign it into its proper place.
+        const T factor = top / leading;
+        if (factor == id_additive<T>::value)
+            break;
 
-        return true;
+        quotients[i] = factor;
+        top = id_additive<T>::value;
+        simd_multiply_subtract(divisors.data(), factor, remainders.data() + i, divisors.size() - 1);
     }
+
+    quotient._setDense(quotients);
+    dividend._setDense(remainders);
 }
 
 /* Helper functions to equate two values... needed for floating-point arithmetics. */
@@ -555,32 +794,155 @@ bool Polynomial<T>::isConstant() const
     return (this->degree() == 0 && this->getMember(0) != id_additive<T>::value);
 }
 
+template<typename T>
+bool Polynomial<T>::isMonomial() const
+{
+    return this->m_coefficients.size() == 1;
+}
+
+template<typename T>
+void Polynomial<T>::multiplyScalar(const T& factor)
+{
+    // Multiply every stored member in place. (Zero divisors might make some of them zero, those are removed.)
+    POLYNOM_COUNT(multiplications, this->m_coefficients.size());
+    for (typename Polynomial<T>::coefficientsMap::iterator it = this->m_coefficients.begin();
+        it != this->m_coefficients.end(); )
+    {
+        it->second = it->second * factor;
+        if (it->second == id_additive<T>::value)
+            it = this->m_coefficients.erase(it);
+        else
+            ++it;
+    }
+
+    this->m_degree = (this->m_coefficients.empty() ? 0 : this->m_coefficients.begin()->first);
+}
+
+template<typename T>
+void Polynomial<T>::divideScalar(const T& divisor)
+{
+    // The same as multiplyScalar(), but the type decides what happens on a division by zero.
+    for (typename Polynomial<T>::coefficientsMap::iterator it = this->m_coefficients.begin();
+        it != this->m_coefficients.end(); )
+    {
+        it->second = it->second / divisor;
+        if (it->second == id_additive<T>::value)
+            it = this->m_coefficients.erase(it);
+        else
+            ++it;
+    }
+
+    this->m_degree = (this->m_coefficients.empty() ? 0 : this->m_coefficients.begin()->first);
+}
+
+template<typename T>
+void Polynomial<T>::multiplyMonomial(const size_t power, const T& coefficient)
+{
+    if (power == 0)
+    {
+        this->multiplyScalar(coefficient);
+        return;
+    }
+
+    // The powers are the keys of the map, and those can't be changed in place. But shifting keeps the order,
+    // so the shifted members can be appended to a new map one after the other, in constant time each.
+    typename Polynomial<T>::coefficientsMap shifted(this->m_coefficients.key_comp(), this->m_coefficients.get_allocator());
+    POLYNOM_COUNT(multiplications, this->m_coefficients.size());
+    for (typename Polynomial<T>::coefficientsMap::const_iterator cit = this->m_coefficients.cbegin();
+        cit != this->m_coefficients.cend(); ++cit)
+    {
+        T value = cit->second * coefficient;
+        if (value != id_additive<T>::value)
+            shifted.insert(shifted.end(), std::make_pair(cit->first + power, value));
+    }
+
+    this->m_coefficients.swap(shifted);
+    this->m_degree = (this->m_coefficients.empty() ? 0 : this->m_coefficients.begin()->first);
+}
+
 template<typename T>
 void Polynomial<T>::_performCleanup()
 {
     // Cleanup consists of removing the 0 coefficient parts from the map
-    std::vector<size_t> removePowers;
-    removePowers.reserve(this->m_coefficients.size());
+    POLYNOM_COUNT(cleanups, 1);
+    for (typename Polynomial<T>::coefficientsMap::iterator it = this->m_coefficients.begin();
+        it != this->m_coefficients.end(); )
+    {
+        if (it->second == id_additive<T>::value)
+            it = this->m_coefficients.erase(it);
+        else
+            ++it;
+    }
 
-    // And keeping the degree of the object the degree of the polynomial
-    size_t maxPower = 0;
+    // And keeping the degree of the object the degree of the polynomial:
+    // the map is in descending order of the powers, so the first member is the leading one.
+    this->m_degree = (this->m_coefficients.empty() ? 0 : this->m_coefficients.begin()->first);
+}
 
-    // Get the 0 coefficient elements from the map
+template<typename T>
+void Polynomial<T>::getCoefficients(CoefficientBuffer<T>& coefficients) const
+{
+    this->_getDense(coefficients);
+}
+
+template<typename T>
+void Polynomial<T>::_getDense(CoefficientBuffer<T>& coefficients) const
+{
+    coefficients.assign(this->degree() + 1, id_additive<T>::value);
     for (typename Polynomial<T>::coefficientsMap::const_iterator cit = this->m_coefficients.cbegin();
         cit != this->m_coefficients.cend(); ++cit)
+        coefficients[cit->first] = cit->second;
+}
+
+template<typename T>
+void Polynomial<T>::_setDense(const CoefficientBuffer<T>& coefficients)
+{
+    // Go from the top, so that every member is inserted to the end of the (descending) map.
+    this->m_coefficients.clear();
+    for (size_t power = coefficients.size(); power-- > 0; )
+        if (coefficients[power] != id_additive<T>::value)
+            this->m_coefficients.insert(this->m_coefficients.end(), std::make_pair(power, coefficients[power]));
+
+    this->m_degree = (this->m_coefficients.empty() ? 0 : this->m_coefficients.begin()->first);
+}
+
+template<typename T>
+void Polynomial<T>::_subtractLeading(const Polynomial<T>& poly, const size_t shift, const T& factor)
+{
+    typename Polynomial<T>::coefficientsMap::const_iterator cit = poly.m_coefficients.cbegin();
+
+    // The leading members cancel each other by definition. For inexact (floating-point) types, the calculated
+    // difference might be some tiny number instead of zero, which would be left there forever, so it's removed.
+    // (For integers, an inexact quotient (5 / 3 = 1) leaves a real remainder which must be kept.)
+    if (!std::numeric_limits<T>::is_integer)
     {
-        if (cit->second == id_additive<T>::value)
-            removePowers.push_back(cit->first);
-        else
-            if (cit->first > maxPower)
-                maxPower = cit->first;
+        this->setMember(cit->first + shift, id_additive<T>::value);
+        ++cit;
     }
 
-    // Remove the elements
-    for (std::vector<size_t>::const_iterator cit = removePowers.cbegin(); cit != removePowers.cend(); ++cit)
-        this->m_coefficients.erase(*cit);
+    for (; cit != poly.m_coefficients.cend(); ++cit)
+    {
+        POLYNOM_COUNT(multiplications, 1);
+        this->_addToMember(cit->first + shift, cit->second * factor, true);
+    }
+}
 
-    this->m_degree = maxPower;
+template<typename T>
+void Polynomial<T>::_addToMember(const size_t index, const T& coefficient, const bool subtract)
+{
+    POLYNOM_COUNT(additions, 1);
+    typename Polynomial<T>::coefficientsMap::iterator it = this->m_coefficients.find(index);
+    if (it == this->m_coefficients.end())
+        // A missing member is zero: 0 + c = c and 0 - c = -c
+        this->setMember(index, (subtract ? id_additive<T>::value - coefficient : coefficient));
+    else
+    {
+        T sum = (subtract ? it->second - coefficient : it->second + coefficient);
+        if (sum != id_additive<T>::value)
+            it->second = sum;
+        else
+            this->setMember(index, sum); // Let setMember() remove the member and fix the degree
+    }
 }
 
 template<typename T>
@@ -600,6 +962,29 @@ Polynomial<T> operator+(const Polynomial<T>& a, const Polynomial<T>& b)
     return ret;
 }
 
+template<typename T>
+Polynomial<T> operator+(Polynomial<T>&& a, const Polynomial<T>& b)
+{
+    // The temporary left-hand operand is not needed anymore, so the sum can be calculated in it.
+    a.add(b);
+    return std::move(a);
+}
+
+template<typename T>
+Polynomial<T> operator+(const Polynomial<T>& a, Polynomial<T>&& b)
+{
+    // Addition is commutative, so the right-hand temporary can be reused as well.
+    b.add(a);
+    return std::move(b);
+}
+
+template<typename T>
+Polynomial<T> operator+(Polynomial<T>&& a, Polynomial<T>&& b)
+{
+    a.add(b);
+    return std::move(a);
+}
+
 template<typename T>
 Polynomial<T> operator-(const Polynomial<T>& a, const Polynomial<T>& b)
 {
@@ -609,6 +994,20 @@ Polynomial<T> operator-(const Polynomial<T>& a, const Polynomial<T>& b)
     return ret;
 }
 
+template<typename T>
+Polynomial<T> operator-(Polynomial<T>&& a, const Polynomial<T>& b)
+{
+    a.subtract(b);
+    return std::move(a);
+}
+
+template<typename T>
+Polynomial<T> operator-(Polynomial<T>&& a, Polynomial<T>&& b)
+{
+    a.subtract(b);
+    return std::move(a);
+}
+
 template<typename T>
 Polynomial<T> operator*(const Polynomial<T>& a, const Polynomial<T>& b)
 {
@@ -618,6 +1017,22 @@ Polynomial<T> operator*(const Polynomial<T>& a, const Polynomial<T>& b)
     return ret;
 }
 
+template<typename T>
+Polynomial<T> operator*(Polynomial<T>&& a, const Polynomial<T>& b)
+{
+    // Only the left-hand temporary is reused: swapping the operands would change the order
+    // in which the products are summed, and so the result for floating-point coefficients.
+    a.multiply(b);
+    return std::move(a);
+}
+
+template<typename T>
+Polynomial<T> operator*(Polynomial<T>&& a, Polynomial<T>&& b)
+{
+    a.multiply(b);
+    return std::move(a);
+}
+
 template<typename T>
 Polynomial<T> operator/(const Polynomial<T>& a, const Polynomial<T>& b)
 {
@@ -629,6 +1044,17 @@ Polynomial<T> operator/(const Polynomial<T>& a, const Polynomial<T>& b)
     return q;
 }
 
+template<typename T>
+Polynomial<T> operator/(Polynomial<T>&& a, const Polynomial<T>& b)
+{
+    // The temporary dividend can be consumed by the division directly, without copying it first.
+    Polynomial<T> q; // quotient
+    if (!b.isNull())
+        Polynomial<T>::_longDivision(a, b, q);
+
+    return q;
+}
+
 template<typename T>
 Polynomial<T> operator%(const Polynomial<T>& a, const Polynomial<T>& b)
 {
@@ -640,6 +1066,67 @@ Polynomial<T> operator%(const Polynomial<T>& a, const Polynomial<T>& b)
     return r;
 }
 
+template<typename T>
+Polynomial<T> operator%(Polynomial<T>&& a, const Polynomial<T>& b)
+{
+    // The division leaves the remainder in the temporary dividend.
+    if (b.isNull())
+        return Polynomial<T>();
+
+    Polynomial<T> q; // quotient
+    Polynomial<T>::_longDivision(a, b, q);
+
+    return std::move(a);
+}
+
+template<typename T>
+Polynomial<T> operator*(const Polynomial<T>& a, const typename polynomial_scalar<T>::type& c)
+{
+    Polynomial<T> ret = a;
+    ret.multiplyScalar(c);
+
+    return ret;
+}
+
+template<typename T>
+Polynomial<T> operator*(Polynomial<T>&& a, const typename polynomial_scalar<T>::type& c)
+{
+    a.multiplyScalar(c);
+    return std::move(a);
+}
+
+template<typename T>
+Polynomial<T> operator*(const typename polynomial_scalar<T>::type& c, const Polynomial<T>& a)
+{
+    Polynomial<T> ret = a;
+    ret.multiplyScalar(c);
+
+    return ret;
+}
+
+template<typename T>
+Polynomial<T> operator*(const typename polynomial_scalar<T>::type& c, Polynomial<T>&& a)
+{
+    a.multiplyScalar(c);
+    return std::move(a);
+}
+
+template<typename T>
+Polynomial<T> operator/(const Polynomial<T>& a, const typename polynomial_scalar<T>::type& c)
+{
+    Polynomial<T> ret = a;
+    ret.divideScalar(c);
+
+    return ret;
+}
+
+template<typename T>
+Polynomial<T> operator/(Polynomial<T>&& a, const typename polynomial_scalar<T>::type& c)
+{
+    a.divideScalar(c);
+    return std::move(a);
+}
+
 // The 'phi' functions of polynomials (in the Euclidean ring order) is their degree
 template<typename T>
 bool operator<(const Polynomial<T>& a, const Polynomial<T>& b)
@@ -677,4 +1164,6 @@ template<typename T> struct id_additive<Polynomial<T>> { static Polynomial<T> co
 template<typename T> Polynomial<T> const id_additive<Polynomial<T>>::value = Polynomial<T>(id_additive<T>::value);
 #endif // _ADD_MULT_IDENTITY_H
 
+#include "PolynomialExpression.hpp"
+
 #endif // _POLYNOMIAL_H
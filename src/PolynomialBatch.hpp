@@ -0,0 +1,428 @@
+#ifndef _POLYNOMIAL_BATCH_H
+#define _POLYNOMIAL_BATCH_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "add_mult_identity.hpp"
+#include "Instrumentation.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "Residue.hpp"
+#include "SimdKernels.hpp"
+#include "ThreadPool.hpp"
+
+// Batches of many small polynomials of the same degree, and the operations on all of them at once.
+//
+// A batch stores its coefficients in a structure-of-arrays layout: the coefficients of x^i of all polynomials
+// are next to each other (the "lanes" of x^i). The operations run the same loop on every polynomial of the batch,
+// with the polynomials in the innermost loop, so the compiler can calculate several of them with one SIMD
+// instruction. Polynomial<T> keeps its members in a map, which is flexible, but for thousands of degree 8-32
+// multiplications the allocations and the lookups cost more than the arithmetic.
+//
+// The degree of a batch is the degree every polynomial in it has at most (the higher coefficients of a
+// polynomial can be zero). The operations work on blocks of BATCH_BLOCK_LANES polynomials, so the lanes of a
+// block stay in the cache; given a ThreadPool, the blocks are shared between the threads.
+
+// The number of polynomials the batch operations work on at once
+const size_t BATCH_BLOCK_LANES = 256;
+
+// How the coefficients are stored in the lanes of a batch, and the arithmetic on them, a lane (or a part of it)
+// at once. By default the lanes are of T, and the operators of T are used in plain loops.
+//
+// The second factors of the products (the lanes of the divisors, the points...) are used for many products,
+// so they are prepared once per block, and the quotients are calculated with the prepared divisors.
+template<typename T>
+struct batch_lane
+{
+    typedef T type;
+
+    static type load(const T& value) { return value; }
+    static T store(const type& value) { return value; }
+    static type zero() { return id_additive<T>::value; }
+    static bool isZero(const type& value) { return value == id_additive<T>::value; }
+
+    static void prepareFactors(const type* values, type* prepared, const size_t n)
+    {
+        std::copy(values, values + n, prepared);
+    }
+
+    // result[k] = base[k] + a[k] * b[k] (or base[k] - a[k] * b[k]; base can be null for 0), b prepared.
+    // (result can be base or a)
+    static void multiplyElements(const type* base, const type* a, const type* b, type* result, const size_t n,
+        const bool subtract)
+    {
+        if (base == nullptr)
+        {
+            for (size_t k = 0; k < n; ++k)
+                result[k] = a[k] * b[k];
+        }
+        else if (subtract)
+        {
+            for (size_t k = 0; k < n; ++k)
+                result[k] = base[k] - a[k] * b[k];
+        }
+        else
+        {
+            for (size_t k = 0; k < n; ++k)
+                result[k] = base[k] + a[k] * b[k];
+        }
+        POLYNOM_COUNT(multiplications, n);
+        POLYNOM_COUNT(additions, base ? n : 0);
+    }
+
+    // result[k] = a[k] / divisors[k], the divisors prepared. These are the divisions of T, so the quotients are
+    // rounded exactly like those of Polynomial::divide().
+    static void prepareDivisors(const type* values, type* prepared, const size_t n)
+    {
+        std::copy(values, values + n, prepared);
+    }
+
+    static void divideElements(const type* a, const type* divisors, type* result, const size_t n)
+    {
+        for (size_t k = 0; k < n; ++k)
+            result[k] = a[k] / divisors[k];
+        POLYNOM_COUNT(multiplications, n);
+    }
+};
+
+// Residues use the element-wise Montgomery kernels of SimdKernels.hpp: the prepared factors are in the
+// Montgomery form, and the divisions are multiplications by the prepared inverses.
+template<long M>
+struct batch_lane<ResidueNum<M>>
+{
+    typedef ResidueNum<M> type;
+    typedef simd_kernels<ResidueNum<M>> kernels;
+
+    static type load(const ResidueNum<M>& value) { return value; }
+    static ResidueNum<M> store(const type& value) { return value; }
+    static type zero() { return id_additive<ResidueNum<M>>::value; }
+    static bool isZero(const type& value) { return value.number() == 0; }
+
+    static void prepareFactors(const type* values, type* prepared, const size_t n)
+    {
+        kernels::prepareFactors(values, prepared, n);
+    }
+
+    static void multiplyElements(const type* base, const type* a, const type* b, type* result, const size_t n,
+        const bool subtract)
+    {
+        kernels::multiplyElements(base, a, b, result, n, subtract);
+    }
+
+    static void prepareDivisors(const type* values, type* prepared, const size_t n)
+    {
+        for (size_t k = 0; k < n; ++k)
+            prepared[k] = id_multiplicative<ResidueNum<M>>::value / values[k];
+        kernels::prepareFactors(prepared, prepared, n);
+    }
+
+    static void divideElements(const type* a, const type* divisors, type* result, const size_t n)
+    {
+        kernels::multiplyElements(nullptr, a, divisors, result, n, false);
+    }
+};
+
+template<typename T>
+class PolynomialBatch
+{
+    public:
+        typedef typename batch_lane<T>::type lane_type;
+
+        // An empty batch, or count nullpolynomials of (at most) the given degree
+        PolynomialBatch<T>();
+        PolynomialBatch<T>(const size_t count, const size_t degree);
+
+        // The number of polynomials and their (maximal) degree
+        size_t size() const;
+        size_t degree() const;
+
+        // Make the batch count nullpolynomials of the given degree. The storage is kept if it is large enough,
+        // so a batch used for the results of many calls is only allocated once.
+        void reset(const size_t count, const size_t degree);
+
+        // The coefficient of x^power of the polynomial at index
+        T coefficient(const size_t index, const size_t power) const;
+        void setCoefficient(const size_t index, const size_t power, const T& value);
+
+        // The polynomial at index, or set it (its degree can't be higher than the batch's)
+        Polynomial<T> polynomial(const size_t index) const;
+        void setPolynomial(const size_t index, const Polynomial<T>& poly);
+
+        // The coefficients of x^power of every polynomial, size() long
+        lane_type* lanes(const size_t power);
+        const lane_type* lanes(const size_t power) const;
+
+    private:
+        size_t m_count;
+        size_t m_degree;
+        // (degree + 1) * count coefficients, the lanes of x^0 first
+        CoefficientBuffer<lane_type> m_lanes;
+};
+
+template<typename T>
+PolynomialBatch<T>::PolynomialBatch()
+{
+    this->m_count = 0;
+    this->m_degree = 0;
+}
+
+template<typename T>
+PolynomialBatch<T>::PolynomialBatch(const size_t count, const size_t degree)
+{
+    this->reset(count, degree);
+}
+
+template<typename T>
+size_t PolynomialBatch<T>::size() const
+{
+    return this->m_count;
+}
+
+template<typename T>
+size_t PolynomialBatch<T>::degree() const
+{
+    return this->m_degree;
+}
+
+template<typename T>
+void PolynomialBatch<T>::reset(const size_t count, const size_t degree)
+{
+    this->m_count = count;
+    this->m_degree = degree;
+    this->m_lanes.assign((degree + 1) * count, batch_lane<T>::zero());
+}
+
+template<typename T>
+T PolynomialBatch<T>::coefficient(const size_t index, const size_t power) const
+{
+    if (power > this->m_degree)
+        return id_additive<T>::value;
+    return batch_lane<T>::store(this->m_lanes[power * this->m_count + index]);
+}
+
+template<typename T>
+void PolynomialBatch<T>::setCoefficient(const size_t index, const size_t power, const T& value)
+{
+    if (power > this->m_degree)
+        throw std::invalid_argument("The power is above the degree of the batch.");
+    this->m_lanes[power * this->m_count + index] = batch_lane<T>::load(value);
+}
+
+template<typename T>
+Polynomial<T> PolynomialBatch<T>::polynomial(const size_t index) const
+{
+    CoefficientBuffer<T> coefficients(this->m_degree + 1);
+    for (size_t power = 0; power <= this->m_degree; ++power)
+        coefficients[power] = this->coefficient(index, power);
+    return Polynomial<T>(coefficients.cbegin(), coefficients.cend());
+}
+
+template<typename T>
+void PolynomialBatch<T>::setPolynomial(const size_t index, const Polynomial<T>& poly)
+{
+    if (poly.degree() > this->m_degree)
+        throw std::invalid_argument("The degree of the polynomial is above the degree of the batch.");
+
+    CoefficientBuffer<T> coefficients;
+    poly.getCoefficients(coefficients);
+    for (size_t power = 0; power <= this->m_degree; ++power)
+        this->m_lanes[power * this->m_count + index] =
+            (power < coefficients.size() ? batch_lane<T>::load(coefficients[power]) : batch_lane<T>::zero());
+}
+
+template<typename T>
+typename PolynomialBatch<T>::lane_type* PolynomialBatch<T>::lanes(const size_t power)
+{
+    return this->m_lanes.data() + power * this->m_count;
+}
+
+template<typename T>
+const typename PolynomialBatch<T>::lane_type* PolynomialBatch<T>::lanes(const size_t power) const
+{
+    return this->m_lanes.data() + power * this->m_count;
+}
+
+// Run body(begin, end) on the blocks of count lanes, on the pool if there is one
+template<typename F>
+void _batch_for_blocks(ThreadPool* pool, const size_t count, F body)
+{
+    const size_t blocks = (count + BATCH_BLOCK_LANES - 1) / BATCH_BLOCK_LANES;
+    const auto block = [count, &body](size_t i)
+    {
+        body(i * BATCH_BLOCK_LANES, std::min(count, (i + 1) * BATCH_BLOCK_LANES));
+    };
+
+    if (pool == nullptr || blocks < 2)
+    {
+        for (size_t i = 0; i < blocks; ++i)
+            block(i);
+    }
+    else
+        pool->parallel_for(0, blocks, block);
+}
+
+template<typename T>
+void _batch_multiply(const PolynomialBatch<T>& a, const PolynomialBatch<T>& b, PolynomialBatch<T>& result,
+    ThreadPool* pool)
+{
+    typedef batch_lane<T> lane;
+    if (a.size() != b.size())
+        throw std::invalid_argument("The batches are of different sizes.");
+    if (&result == &a || &result == &b)
+        throw std::invalid_argument("The result of a batch operation can't be one of its operands.");
+
+    POLYNOM_PHASE("batch.multiply");
+    const size_t n = a.degree(), m = b.degree();
+    result.reset(a.size(), n + m);
+
+    _batch_for_blocks(pool, a.size(), [&a, &b, &result, n, m](size_t begin, size_t end)
+    {
+        const size_t length = end - begin;
+        CoefficientBuffer<typename lane::type> factors((m + 1) * length);
+        for (size_t j = 0; j <= m; ++j)
+            lane::prepareFactors(b.lanes(j) + begin, factors.data() + j * length, length);
+
+        // Schoolbook: for these degrees it beats Karatsuba's method
+        for (size_t i = 0; i <= n; ++i)
+            for (size_t j = 0; j <= m; ++j)
+            {
+                typename lane::type* r = result.lanes(i + j) + begin;
+                lane::multiplyElements(r, a.lanes(i) + begin, factors.data() + j * length, r, length, false);
+            }
+    });
+}
+
+template<typename T>
+void _batch_divide(const PolynomialBatch<T>& a, const PolynomialBatch<T>& b, PolynomialBatch<T>& quotient,
+    PolynomialBatch<T>& remainder, ThreadPool* pool)
+{
+    typedef batch_lane<T> lane;
+    if (a.size() != b.size())
+        throw std::invalid_argument("The batches are of different sizes.");
+    if (&quotient == &remainder || &quotient == &a || &quotient == &b || &remainder == &a || &remainder == &b)
+        throw std::invalid_argument("The result of a batch operation can't be one of its operands.");
+
+    // The divisors go in lockstep, so every one of them must be of the degree of the batch
+    const size_t count = a.size(), n = a.degree(), m = b.degree();
+    const typename lane::type* leading = b.lanes(m);
+    for (size_t k = 0; k < count; ++k)
+        if (lane::isZero(leading[k]))
+            throw std::invalid_argument("The leading coefficient of a divisor in the batch is zero.");
+
+    POLYNOM_PHASE("batch.divide");
+    if (n < m)
+    {
+        quotient.reset(count, 0);
+        remainder = a;
+        return;
+    }
+
+    // The long division, on a copy of the dividends
+    PolynomialBatch<T> work(a);
+    quotient.reset(count, n - m);
+    _batch_for_blocks(pool, count, [&b, &work, &quotient, leading, n, m](size_t begin, size_t end)
+    {
+        const size_t length = end - begin;
+        CoefficientBuffer<typename lane::type> divisors(length), factors(m * length);
+        lane::prepareDivisors(leading + begin, divisors.data(), length);
+        for (size_t j = 0; j < m; ++j)
+            lane::prepareFactors(b.lanes(j) + begin, factors.data() + j * length, length);
+
+        for (size_t i = n - m + 1; i-- > 0; )
+        {
+            typename lane::type* q = quotient.lanes(i) + begin;
+            lane::divideElements(work.lanes(i + m) + begin, divisors.data(), q, length);
+
+            for (size_t j = 0; j < m; ++j)
+            {
+                typename lane::type* w = work.lanes(i + j) + begin;
+                lane::multiplyElements(w, q, factors.data() + j * length, w, length, true);
+            }
+        }
+    });
+
+    remainder.reset(count, m == 0 ? 0 : m - 1);
+    if (m > 0)
+        std::copy(work.lanes(0), work.lanes(0) + m * count, remainder.lanes(0));
+}
+
+template<typename T>
+void _batch_evaluate(const PolynomialBatch<T>& a, const std::vector<T>& points, std::vector<T>& values,
+    ThreadPool* pool)
+{
+    typedef batch_lane<T> lane;
+    if (points.size() != a.size())
+        throw std::invalid_argument("The number of the points differs from the size of the batch.");
+
+    POLYNOM_PHASE("batch.evaluate");
+    const size_t n = a.degree();
+    values.resize(a.size());
+
+    _batch_for_blocks(pool, a.size(), [&a, &points, &values, n](size_t begin, size_t end)
+    {
+        // Horner's scheme, on the lanes of the block
+        typename lane::type x[BATCH_BLOCK_LANES], sum[BATCH_BLOCK_LANES];
+        const size_t length = end - begin;
+        const typename lane::type* top = a.lanes(n) + begin;
+        for (size_t k = 0; k < length; ++k)
+        {
+            x[k] = lane::load(points[begin + k]);
+            sum[k] = top[k];
+        }
+        lane::prepareFactors(x, x, length);
+
+        for (size_t i = n; i-- > 0; )
+            lane::multiplyElements(a.lanes(i) + begin, sum, x, sum, length, false);
+
+        for (size_t k = 0; k < length; ++k)
+            values[begin + k] = lane::store(sum[k]);
+    });
+}
+
+// result[k] = a[k] * b[k] for every polynomial of the batches (which must be of the same size)
+template<typename T>
+void batch_multiply(const PolynomialBatch<T>& a, const PolynomialBatch<T>& b, PolynomialBatch<T>& result)
+{
+    _batch_multiply(a, b, result, nullptr);
+}
+
+template<typename T>
+void batch_multiply(const PolynomialBatch<T>& a, const PolynomialBatch<T>& b, PolynomialBatch<T>& result,
+    ThreadPool& pool)
+{
+    _batch_multiply(a, b, result, &pool);
+}
+
+// a[k] = b[k] * quotient[k] + remainder[k] for every polynomial of the batches. The coefficients must be from
+// a field, and every divisor must be of the degree of its batch (its leading coefficient can't be zero).
+template<typename T>
+void batch_divide(const PolynomialBatch<T>& a, const PolynomialBatch<T>& b, PolynomialBatch<T>& quotient,
+    PolynomialBatch<T>& remainder)
+{
+    _batch_divide(a, b, quotient, remainder, nullptr);
+}
+
+template<typename T>
+void batch_divide(const PolynomialBatch<T>& a, const PolynomialBatch<T>& b, PolynomialBatch<T>& quotient,
+    PolynomialBatch<T>& remainder, ThreadPool& pool)
+{
+    _batch_divide(a, b, quotient, remainder, &pool);
+}
+
+// values[k] = a[k](points[k]) for every polynomial of the batch
+template<typename T>
+void batch_evaluate(const PolynomialBatch<T>& a, const std::vector<T>& points, std::vector<T>& values)
+{
+    _batch_evaluate(a, points, values, nullptr);
+}
+
+template<typename T>
+void batch_evaluate(const PolynomialBatch<T>& a, const std::vector<T>& points, std::vector<T>& values,
+    ThreadPool& pool)
+{
+    _batch_evaluate(a, points, values, &pool);
+}
+
+#endif // _POLYNOMIAL_BATCH_H
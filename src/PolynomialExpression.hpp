@@ -0,0 +1,265 @@
+#ifndef _POLYNOMIAL_EXPRESSION_H
+#define _POLYNOMIAL_EXPRESSION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+#include "add_mult_identity.hpp"
+#include "Polynomial.hpp"
+
+// Expression templates over polynomials.
+//
+// The operators of polynomials calculate their results right away, so an expression like a + c*b - d creates
+// a temporary polynomial for c*b, another one for a + c*b, and only then the result.
+// Instead, scaled(c, b) creates a lightweight expression object which only refers to its operands. Adding or
+// subtracting an expression and a polynomial (or two expressions), or scaling an expression, creates another
+// expression, and so on. Nothing is calculated until the expression is assigned into a polynomial:
+// then every operand's coefficients are summed into the destination's buffer in a single pass.
+//
+// Expressions refer to their operands, so they must be assigned before the operands go away.
+// (Don't store them in 'auto' variables!) That's why only scaled() starts an expression: c * b and b * c
+// are polynomials, as are the sums of two polynomials.
+
+// Base class of every expression. E is the actual expression class which must implement:
+//  - degreeBound(): an upper bound of the expression's degree
+//  - accumulate(buffer, factor, negate): add (or subtract, if negate is true) the expression's coefficients
+//    multiplied by *factor (or by 1, if the factor is null) to the buffer
+template<typename T, typename E>
+class PolynomialExpression
+{
+    public:
+        const E& expression() const
+        {
+            return static_cast<const E&>(*this);
+        }
+
+        size_t degreeBound() const
+        {
+            return this->expression().degreeBound();
+        }
+
+        void accumulate(CoefficientBuffer<T>& buffer, const T* factor, const bool negate) const
+        {
+            this->expression().accumulate(buffer, factor, negate);
+        }
+
+        // Calculate the expression's value
+        Polynomial<T> evaluate() const
+        {
+            return Polynomial<T>(*this);
+        }
+};
+
+// Leaf of the expression: a polynomial
+template<typename T>
+class PolynomialTerm : public PolynomialExpression<T, PolynomialTerm<T>>
+{
+    public:
+        PolynomialTerm(const Polynomial<T>& poly) : m_poly(poly) {}
+
+        size_t degreeBound() const
+        {
+            return this->m_poly.degree();
+        }
+
+        void accumulate(CoefficientBuffer<T>& buffer, const T* factor, const bool negate) const
+        {
+            // Only the stored (non-zero) members have to be visited.
+            for (typename Polynomial<T>::coefficientsMap::const_iterator cit = this->m_poly.m_coefficients.cbegin();
+                cit != this->m_poly.m_coefficients.cend(); ++cit)
+            {
+                T value = (factor ? *factor * cit->second : cit->second);
+                buffer[cit->first] = (negate ? buffer[cit->first] - value : buffer[cit->first] + value);
+            }
+        }
+
+    private:
+        const Polynomial<T>& m_poly;
+};
+
+// c * E
+template<typename T, typename E>
+class PolynomialScaled : public PolynomialExpression<T, PolynomialScaled<T, E>>
+{
+    public:
+        PolynomialScaled(const T& scalar, const E& expr) : m_scalar(scalar), m_expr(expr) {}
+
+        size_t degreeBound() const
+        {
+            return this->m_expr.degreeBound();
+        }
+
+        void accumulate(CoefficientBuffer<T>& buffer, const T* factor, const bool negate) const
+        {
+            // Nested scalings are folded into one factor, so every coefficient is only multiplied once.
+            T scalar = (factor ? *factor * this->m_scalar : this->m_scalar);
+            this->m_expr.accumulate(buffer, &scalar, negate);
+        }
+
+    private:
+        T m_scalar;
+        E m_expr;
+};
+
+// L + R
+template<typename T, typename L, typename R>
+class PolynomialSum : public PolynomialExpression<T, PolynomialSum<T, L, R>>
+{
+    public:
+        PolynomialSum(const L& left, const R& right) : m_left(left), m_right(right) {}
+
+        size_t degreeBound() const
+        {
+            return std::max(this->m_left.degreeBound(), this->m_right.degreeBound());
+        }
+
+        void accumulate(CoefficientBuffer<T>& buffer, const T* factor, const bool negate) const
+        {
+            this->m_left.accumulate(buffer, factor, negate);
+            this->m_right.accumulate(buffer, factor, negate);
+        }
+
+    private:
+        L m_left;
+        R m_right;
+};
+
+// L - R
+template<typename T, typename L, typename R>
+class PolynomialDifference : public PolynomialExpression<T, PolynomialDifference<T, L, R>>
+{
+    public:
+        PolynomialDifference(const L& left, const R& right) : m_left(left), m_right(right) {}
+
+        size_t degreeBound() const
+        {
+            return std::max(this->m_left.degreeBound(), this->m_right.degreeBound());
+        }
+
+        void accumulate(CoefficientBuffer<T>& buffer, const T* factor, const bool negate) const
+        {
+            this->m_left.accumulate(buffer, factor, negate);
+            this->m_right.accumulate(buffer, factor, !negate);
+        }
+
+    private:
+        L m_left;
+        R m_right;
+};
+
+/* Members of Polynomial<T> working on expressions */
+template<typename T>
+template<typename E>
+Polynomial<T>::Polynomial(const PolynomialExpression<T, E>& expression)
+{
+    CoefficientBuffer<T> buffer(expression.degreeBound() + 1, id_additive<T>::value);
+    expression.accumulate(buffer, nullptr, false);
+    this->_setDense(buffer);
+}
+
+template<typename T>
+template<typename E>
+const Polynomial<T>& Polynomial<T>::operator=(const PolynomialExpression<T, E>& expression)
+{
+    // The expression might refer to this polynomial, so it is calculated into a separate buffer first.
+    CoefficientBuffer<T> buffer(expression.degreeBound() + 1, id_additive<T>::value);
+    expression.accumulate(buffer, nullptr, false);
+    this->_setDense(buffer);
+    return *this;
+}
+
+template<typename T>
+template<typename E>
+const Polynomial<T>& Polynomial<T>::operator+=(const PolynomialExpression<T, E>& expression)
+{
+    CoefficientBuffer<T> buffer;
+    this->_getDense(buffer);
+    if (buffer.size() < expression.degreeBound() + 1)
+        buffer.resize(expression.degreeBound() + 1, id_additive<T>::value);
+
+    expression.accumulate(buffer, nullptr, false);
+    this->_setDense(buffer);
+    return *this;
+}
+
+template<typename T>
+template<typename E>
+const Polynomial<T>& Polynomial<T>::operator-=(const PolynomialExpression<T, E>& expression)
+{
+    CoefficientBuffer<T> buffer;
+    this->_getDense(buffer);
+    if (buffer.size() < expression.degreeBound() + 1)
+        buffer.resize(expression.degreeBound() + 1, id_additive<T>::value);
+
+    expression.accumulate(buffer, nullptr, true);
+    this->_setDense(buffer);
+    return *this;
+}
+
+/* Operators building the expressions */
+// Scaling: c * poly, but as an expression
+template<typename T>
+PolynomialScaled<T, PolynomialTerm<T>> scaled(const typename polynomial_scalar<T>::type& c, const Polynomial<T>& poly)
+{
+    return PolynomialScaled<T, PolynomialTerm<T>>(c, PolynomialTerm<T>(poly));
+}
+
+template<typename T, typename E>
+PolynomialScaled<T, E> operator*(const typename polynomial_scalar<T>::type& c, const PolynomialExpression<T, E>& expr)
+{
+    return PolynomialScaled<T, E>(c, expr.expression());
+}
+
+template<typename T, typename E>
+PolynomialScaled<T, E> operator*(const PolynomialExpression<T, E>& expr, const typename polynomial_scalar<T>::type& c)
+{
+    return PolynomialScaled<T, E>(c, expr.expression());
+}
+
+// Addition
+template<typename T, typename L, typename R>
+PolynomialSum<T, L, R> operator+(const PolynomialExpression<T, L>& left, const PolynomialExpression<T, R>& right)
+{
+    return PolynomialSum<T, L, R>(left.expression(), right.expression());
+}
+
+template<typename T, typename E>
+PolynomialSum<T, PolynomialTerm<T>, E> operator+(const Polynomial<T>& left, const PolynomialExpression<T, E>& right)
+{
+    return PolynomialSum<T, PolynomialTerm<T>, E>(PolynomialTerm<T>(left), right.expression());
+}
+
+template<typename T, typename E>
+PolynomialSum<T, E, PolynomialTerm<T>> operator+(const PolynomialExpression<T, E>& left, const Polynomial<T>& right)
+{
+    return PolynomialSum<T, E, PolynomialTerm<T>>(left.expression(), PolynomialTerm<T>(right));
+}
+
+// Subtraction
+template<typename T, typename L, typename R>
+PolynomialDifference<T, L, R> operator-(const PolynomialExpression<T, L>& left, const PolynomialExpression<T, R>& right)
+{
+    return PolynomialDifference<T, L, R>(left.expression(), right.expression());
+}
+
+template<typename T, typename E>
+PolynomialDifference<T, PolynomialTerm<T>, E> operator-(const Polynomial<T>& left, const PolynomialExpression<T, E>& right)
+{
+    return PolynomialDifference<T, PolynomialTerm<T>, E>(PolynomialTerm<T>(left), right.expression());
+}
+
+template<typename T, typename E>
+PolynomialDifference<T, E, PolynomialTerm<T>> operator-(const PolynomialExpression<T, E>& left, const Polynomial<T>& right)
+{
+    return PolynomialDifference<T, E, PolynomialTerm<T>>(left.expression(), PolynomialTerm<T>(right));
+}
+
+// Printing an expression prints its value
+template<typename T, typename E>
+std::ostream& operator<<(std::ostream& o, const PolynomialExpression<T, E>& expr)
+{
+    return o << expr.evaluate();
+}
+
+#endif // _POLYNOMIAL_EXPRESSION_H
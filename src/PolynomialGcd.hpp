@@ -0,0 +1,315 @@
+#ifndef _POLYNOMIAL_GCD_H
+#define _POLYNOMIAL_GCD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "Instrumentation.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "PowerSeries.hpp"
+#include "Thresholds.hpp"
+
+// Division and greatest common divisor of polynomials over a field, on dense coefficient buffers.
+//
+// The buffers are kept trimmed here: the last element is the leading coefficient, and the nullpolynomial is
+// the empty buffer. (So the degree of a non-null polynomial is size() - 1.)
+//
+// The Euclidean algorithm needs O(n^2) operations. Above the threshold the half-gcd algorithm is used: it
+// calculates the first half of the remainder sequence from the top halves of the polynomials only, in the form
+// of a 2x2 polynomial matrix, recursively, so the whole gcd costs O(M(n) log n) where M(n) is the cost of
+// a multiplication.
+
+// Above NEWTON_DIVISION_THRESHOLD the quotient is calculated with a power series inverse instead of the long
+// division, and above HALF_GCD_THRESHOLD the half-gcd algorithm is used instead of Euclid's. The half-gcd
+// recursion stops at HALF_GCD_RECURSION_THRESHOLD: its Euclidean steps also build the matrix, so they are
+// dearer than the plain ones, and the recursion pays off at much shorter lengths than the whole half-gcd does.
+// (Or the tuned thresholds of the coefficient type, see Thresholds.hpp.)
+
+// Remove the zero leading coefficients
+template<typename T>
+void dense_trim(CoefficientBuffer<T>& a)
+{
+    while (!a.empty() && a.back() == id_additive<T>::value)
+        a.pop_back();
+}
+
+// Divide every coefficient by the leading one
+template<typename T>
+void dense_make_monic(CoefficientBuffer<T>& a)
+{
+    if (a.empty() || a.back() == id_multiplicative<T>::value)
+        return;
+
+    const T inverse = id_multiplicative<T>::value / a.back();
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = a[i] * inverse;
+}
+
+// a = q*b + r with deg r < deg b (b must not be null), with the long division below the given length
+template<typename T>
+void _dense_divide(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b,
+    CoefficientBuffer<T>& quotient, CoefficientBuffer<T>& remainder, const size_t threshold)
+{
+    if (b.empty())
+        throw std::invalid_argument("Division by the nullpolynomial.");
+
+    quotient.clear();
+    if (a.size() < b.size())
+    {
+        remainder = a;
+        return;
+    }
+
+    const size_t length = a.size() - b.size() + 1;
+    if (length < threshold || b.size() < threshold)
+    {
+        // Long division, going down from the top
+        remainder = a;
+        quotient.assign(length, id_additive<T>::value);
+
+        const T inverse = id_multiplicative<T>::value / b.back();
+        for (size_t i = length; i-- > 0; )
+        {
+            const T factor = remainder[i + b.size() - 1] * inverse;
+            quotient[i] = factor;
+            if (factor == id_additive<T>::value) continue;
+
+            for (size_t j = 0; j + 1 < b.size(); ++j)
+                remainder[i + j] = remainder[i + j] - factor * b[j];
+            POLYNOM_COUNT(multiplications, b.size() - 1);
+            POLYNOM_COUNT(additions, b.size() - 1);
+        }
+    }
+    else
+    {
+        // The reversed quotient is the reversed a divided by the reversed b, as power series
+        CoefficientBuffer<T> top(length, id_additive<T>::value), reversed(b.rbegin(), b.rend()), inverse, product;
+        for (size_t i = 0; i < length; ++i)
+            top[i] = a[a.size() - 1 - i];
+
+        dense_series_inverse(reversed, length, inverse);
+        dense_multiply_truncated(top, inverse, length, product);
+        quotient.assign(product.rbegin(), product.rend());
+
+        // Only the members below x^deg(b) remain after the subtraction of q*b
+        dense_multiply_truncated(quotient, b, b.size() - 1, product);
+        remainder.assign(a.begin(), a.begin() + (b.size() - 1));
+        for (size_t i = 0; i < remainder.size(); ++i)
+            remainder[i] = remainder[i] - product[i];
+    }
+
+    remainder.resize(b.size() - 1);
+    dense_trim(remainder);
+}
+
+// a = q*b + r with deg r < deg b (b must not be null)
+template<typename T>
+void dense_divide(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b,
+    CoefficientBuffer<T>& quotient, CoefficientBuffer<T>& remainder)
+{
+    _dense_divide(a, b, quotient, remainder, algorithm_thresholds<T>::newtonDivision);
+}
+
+// 2x2 matrix of polynomials, the steps of the Euclidean algorithm: (a, b) -> (b, a - q*b) is the matrix
+//     | 0   1 |
+//     | 1  -q |
+template<typename T>
+struct HalfGcdMatrix
+{
+    CoefficientBuffer<T> m[2][2];
+
+    // Make the identity matrix
+    void setIdentity()
+    {
+        for (size_t i = 0; i < 2; ++i)
+            for (size_t j = 0; j < 2; ++j)
+                this->m[i][j].assign(i == j ? 1 : 0, id_multiplicative<T>::value);
+    }
+};
+
+// result = a + b
+template<typename T>
+void _dense_add(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, CoefficientBuffer<T>& result)
+{
+    result.assign(std::max(a.size(), b.size()), id_additive<T>::value);
+    for (size_t i = 0; i < a.size(); ++i)
+        result[i] = a[i];
+    for (size_t i = 0; i < b.size(); ++i)
+        result[i] = result[i] + b[i];
+    dense_trim(result);
+}
+
+// (a, b) = M * (a, b)
+template<typename T>
+void _half_gcd_apply(const HalfGcdMatrix<T>& matrix, CoefficientBuffer<T>& a, CoefficientBuffer<T>& b)
+{
+    CoefficientBuffer<T> first, second, na, nb;
+    dense_multiply(matrix.m[0][0], a, first);
+    dense_multiply(matrix.m[0][1], b, second);
+    _dense_add(first, second, na);
+    dense_multiply(matrix.m[1][0], a, first);
+    dense_multiply(matrix.m[1][1], b, second);
+    _dense_add(first, second, nb);
+
+    a.swap(na);
+    b.swap(nb);
+}
+
+// result = left * right
+template<typename T>
+void _half_gcd_multiply(const HalfGcdMatrix<T>& left, const HalfGcdMatrix<T>& right, HalfGcdMatrix<T>& result)
+{
+    CoefficientBuffer<T> first, second;
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 2; ++j)
+        {
+            dense_multiply(left.m[i][0], right.m[0][j], first);
+            dense_multiply(left.m[i][1], right.m[1][j], second);
+            _dense_add(first, second, result.m[i][j]);
+        }
+}
+
+// M = | 0  1; 1  -q | * M
+template<typename T>
+void _half_gcd_step(const CoefficientBuffer<T>& q, HalfGcdMatrix<T>& matrix)
+{
+    for (size_t j = 0; j < 2; ++j)
+    {
+        CoefficientBuffer<T> product, row;
+        dense_multiply(q, matrix.m[1][j], product);
+        row.assign(std::max(product.size(), matrix.m[0][j].size()), id_additive<T>::value);
+        for (size_t i = 0; i < matrix.m[0][j].size(); ++i)
+            row[i] = matrix.m[0][j][i];
+        for (size_t i = 0; i < product.size(); ++i)
+            row[i] = row[i] - product[i];
+        dense_trim(row);
+
+        matrix.m[0][j].swap(matrix.m[1][j]);
+        matrix.m[1][j].swap(row);
+    }
+}
+
+// The half-gcd of a and b (deg a > deg b): the product of the Euclidean steps which take (a, b) to the pair of
+// consecutive remainders with degrees straddling deg(a) / 2.
+// (With the Euclidean steps below the given length instead of the recursion.)
+template<typename T>
+void _dense_half_gcd(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, HalfGcdMatrix<T>& result,
+    const size_t threshold)
+{
+    result.setIdentity();
+
+    const size_t half = a.size() / 2; // ceil(deg(a) / 2)
+    if (b.size() <= half)
+        return;
+
+    CoefficientBuffer<T> c, d, q, r;
+    if (a.size() < threshold)
+    {
+        // Short polynomials: simply do the Euclidean steps
+        c = a;
+        d = b;
+        while (d.size() > half)
+        {
+            dense_divide(c, d, q, r);
+            _half_gcd_step(q, result);
+            c.swap(d);
+            d.swap(r);
+        }
+        return;
+    }
+
+    // The quotients of the top halves are the same as the quotients of the whole polynomials
+    // while the remainders are long enough.
+    CoefficientBuffer<T> top_a(a.begin() + half, a.end()), top_b(b.begin() + half, b.end());
+    _dense_half_gcd(top_a, top_b, result, threshold);
+
+    c = a;
+    d = b;
+    _half_gcd_apply(result, c, d);
+    if (d.size() <= half || c.size() <= d.size())
+        return;
+
+    // One step by hand...
+    dense_divide(c, d, q, r);
+    _half_gcd_step(q, result);
+    if (r.size() <= half || 2 * half + 1 < d.size())
+        return;
+
+    // ... and the other half of the degrees, from the top again
+    const size_t shift = 2 * half + 1 - d.size();
+    CoefficientBuffer<T> top_c(d.begin() + std::min(shift, d.size()), d.end());
+    CoefficientBuffer<T> top_d(r.begin() + std::min(shift, r.size()), r.end());
+
+    HalfGcdMatrix<T> second, product;
+    _dense_half_gcd(top_c, top_d, second, threshold);
+    _half_gcd_multiply(second, result, product);
+    std::swap(result, product);
+}
+
+template<typename T>
+void dense_half_gcd(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, HalfGcdMatrix<T>& result)
+{
+    _dense_half_gcd(a, b, result, algorithm_thresholds<T>::halfGcdRecursion);
+}
+
+// The monic greatest common divisor of a and b (the nullpolynomial if both are null), with the half-gcd
+// algorithm from the given length on (and its Euclidean steps below the recursion threshold)
+template<typename T>
+void _dense_gcd(const CoefficientBuffer<T>& a_orig, const CoefficientBuffer<T>& b_orig, CoefficientBuffer<T>& result,
+    const size_t threshold, const size_t recursion)
+{
+    CoefficientBuffer<T> a = a_orig, b = b_orig, q, r;
+    dense_trim(a);
+    dense_trim(b);
+    if (a.size() < b.size())
+        a.swap(b);
+
+    HalfGcdMatrix<T> matrix;
+    while (!b.empty())
+    {
+        if (a.size() >= threshold)
+        {
+            // Jump to the middle of the remainder sequence. (The matrix is invertible, so the gcd stays the same.)
+            POLYNOM_PHASE("gcd.half_gcd");
+            _dense_half_gcd(a, b, matrix, recursion);
+            _half_gcd_apply(matrix, a, b);
+            if (a.size() < b.size())
+                a.swap(b);
+            if (b.empty())
+                break;
+        }
+
+        POLYNOM_PHASE("gcd.euclidean_step");
+        dense_divide(a, b, q, r);
+        a.swap(b);
+        b.swap(r);
+    }
+
+    dense_make_monic(a);
+    result.swap(a);
+}
+
+// The monic greatest common divisor of a and b (the nullpolynomial if both are null)
+template<typename T>
+void dense_gcd(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, CoefficientBuffer<T>& result)
+{
+    _dense_gcd(a, b, result, algorithm_thresholds<T>::halfGcd, algorithm_thresholds<T>::halfGcdRecursion);
+}
+
+/* The same on polynomials */
+// The monic greatest common divisor of a and b
+template<typename T>
+Polynomial<T> polynomial_gcd(const Polynomial<T>& a, const Polynomial<T>& b)
+{
+    CoefficientBuffer<T> lefts, rights, result;
+    a.getCoefficients(lefts);
+    b.getCoefficients(rights);
+    dense_gcd(lefts, rights, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+#endif // _POLYNOMIAL_GCD_H
@@ -0,0 +1,213 @@
+#ifndef _POLYNOMIAL_POWER_H
+#define _POLYNOMIAL_POWER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "PowerSeries.hpp"
+
+// Powers of polynomials with binary exponentiation (square-and-multiply): f^k takes about 2*log2(k)
+// multiplications instead of k. powmod(f, k, g) reduces modulo g after every step, so the operands never
+// grow above the degree of g. (x^(p^k) mod g is the heart of the factorisation over finite fields.)
+//
+// The reduction can be done with the long division (powmod(f, k, g)) or, if the leading coefficient of g can
+// be inverted, with a PolynomialModulus object, which precomputes the inverse of g (reversed) as a power series
+// once. Then every reduction costs two multiplications instead of a long division, Barrett-style:
+// if a has degree < 2*deg(g), the quotient of a / g is rev(rev(a) * rev(g)^-1) truncated to the right length.
+
+template<typename T>
+class PolynomialModulus
+{
+    public:
+        // Precompute the reduction modulo g
+        // (g must not be the nullpolynomial, and its leading coefficient has to be invertible)
+        PolynomialModulus(const Polynomial<T>& g);
+
+        // Get the modulus
+        const Polynomial<T>& modulus() const;
+
+        // Reduce the polynomial: get its remainder modulo g
+        Polynomial<T> reduce(const Polynomial<T>& poly) const;
+
+        // Reduce dense coefficients in place (the result has deg(g) elements)
+        void reduce(CoefficientBuffer<T>& coefficients) const;
+
+        // result = a * b mod g, on dense coefficients
+        void multiply(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b, CoefficientBuffer<T>& result) const;
+
+    private:
+        Polynomial<T> m_modulus;
+
+        // The dense coefficients of g
+        CoefficientBuffer<T> m_coefficients;
+
+        // rev(g)^-1 mod x^deg(g), which is enough to reduce any product of two remainders
+        CoefficientBuffer<T> m_inverse;
+
+        // Calculate the quotient of a / g with the given inverse
+        void _quotient(const CoefficientBuffer<T>& a, const size_t length, const CoefficientBuffer<T>& inverse,
+            CoefficientBuffer<T>& quotient) const;
+};
+
+template<typename T>
+PolynomialModulus<T>::PolynomialModulus(const Polynomial<T>& g) : m_modulus(g)
+{
+    if (g.isNull())
+        throw std::invalid_argument("Reduction modulo the nullpolynomial.");
+
+    g.getCoefficients(this->m_coefficients);
+
+    CoefficientBuffer<T> reversed(this->m_coefficients.rbegin(), this->m_coefficients.rend());
+    dense_series_inverse(reversed, g.degree(), this->m_inverse);
+}
+
+template<typename T>
+const Polynomial<T>& PolynomialModulus<T>::modulus() const
+{
+    return this->m_modulus;
+}
+
+template<typename T>
+Polynomial<T> PolynomialModulus<T>::reduce(const Polynomial<T>& poly) const
+{
+    CoefficientBuffer<T> coefficients;
+    poly.getCoefficients(coefficients);
+    this->reduce(coefficients);
+    return Polynomial<T>(coefficients.cbegin(), coefficients.cend());
+}
+
+template<typename T>
+void PolynomialModulus<T>::reduce(CoefficientBuffer<T>& coefficients) const
+{
+    const size_t degree = this->m_modulus.degree();
+
+    // Everything is divisible by a constant
+    if (degree == 0)
+        coefficients.clear();
+    else if (coefficients.size() > degree)
+    {
+        // The quotient has this many members
+        const size_t length = coefficients.size() - degree;
+
+        CoefficientBuffer<T> quotient;
+        if (length <= this->m_inverse.size())
+            this->_quotient(coefficients, length, this->m_inverse, quotient);
+        else
+        {
+            // Longer than any product of two remainders: the precomputed inverse isn't long enough
+            CoefficientBuffer<T> reversed(this->m_coefficients.rbegin(), this->m_coefficients.rend()), inverse;
+            dense_series_inverse(reversed, length, inverse);
+            this->_quotient(coefficients, length, inverse, quotient);
+        }
+
+        // Only the members below x^deg(g) survive the subtraction of quotient * g
+        CoefficientBuffer<T> product;
+        dense_multiply_truncated(quotient, this->m_coefficients, degree, product);
+        for (size_t i = 0; i < degree; ++i)
+            coefficients[i] = coefficients[i] - product[i];
+    }
+
+    coefficients.resize(degree, id_additive<T>::value);
+}
+
+template<typename T>
+void PolynomialModulus<T>::multiply(const CoefficientBuffer<T>& a, const CoefficientBuffer<T>& b,
+    CoefficientBuffer<T>& result) const
+{
+    dense_multiply(a, b, result);
+    this->reduce(result);
+}
+
+template<typename T>
+void PolynomialModulus<T>::_quotient(const CoefficientBuffer<T>& a, const size_t length,
+    const CoefficientBuffer<T>& inverse, CoefficientBuffer<T>& quotient) const
+{
+    // The top members of a, reversed
+    CoefficientBuffer<T> top(length, id_additive<T>::value);
+    for (size_t i = 0; i < length; ++i)
+        top[i] = a[a.size() - 1 - i];
+
+    CoefficientBuffer<T> reversed;
+    dense_multiply_truncated(top, inverse, length, reversed);
+    quotient.assign(reversed.rbegin(), reversed.rend());
+}
+
+// f^k
+template<typename T>
+Polynomial<T> pow(const Polynomial<T>& f, unsigned long long k)
+{
+    CoefficientBuffer<T> result(1, id_multiplicative<T>::value), square, product;
+    f.getCoefficients(square);
+
+    while (k > 0)
+    {
+        if (k & 1)
+        {
+            dense_multiply(result, square, product);
+            result.swap(product);
+        }
+
+        k >>= 1;
+        if (k > 0)
+        {
+            dense_multiply(square, square, product);
+            square.swap(product);
+        }
+    }
+
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// f^k mod g, reducing with the long division
+template<typename T>
+Polynomial<T> powmod(const Polynomial<T>& f, unsigned long long k, const Polynomial<T>& g)
+{
+    Polynomial<T> result = Polynomial<T>(id_multiplicative<T>::value) % g;
+    Polynomial<T> square = f % g;
+
+    while (k > 0)
+    {
+        if (k & 1)
+            result = (result * square) % g;
+
+        k >>= 1;
+        if (k > 0)
+            square = (square * square) % g;
+    }
+
+    return result;
+}
+
+// f^k mod g, reducing with the precomputed modulus
+template<typename T>
+Polynomial<T> powmod(const Polynomial<T>& f, unsigned long long k, const PolynomialModulus<T>& g)
+{
+    CoefficientBuffer<T> result(1, id_multiplicative<T>::value), square, product;
+    g.reduce(result);
+    f.getCoefficients(square);
+    g.reduce(square);
+
+    while (k > 0)
+    {
+        if (k & 1)
+        {
+            g.multiply(result, square, product);
+            result.swap(product);
+        }
+
+        k >>= 1;
+        if (k > 0)
+        {
+            g.multiply(square, square, product);
+            square.swap(product);
+        }
+    }
+
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+#endif // _POLYNOMIAL_POWER_H
@@ -0,0 +1,259 @@
+#ifndef _POWER_SERIES_H
+#define _POWER_SERIES_H
+
+#include <cstddef>
+#include <stdexcept>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+
+// Truncated power series: polynomials modulo x^n.
+//
+// A power series with a non-zero constant term has a multiplicative inverse, and series like 1 + a1*x + ...
+// have logarithms and square roots, which are infinite series even if the argument is a polynomial.
+// These functions calculate the first n coefficients of them with Newton's iteration: every step doubles the
+// number of correct coefficients and costs a few truncated multiplications, so the whole calculation costs
+// about as much as a few multiplications of n long polynomials (with Karatsuba's method, see DenseMultiplication.hpp).
+//
+// The coefficients must be from a field (T has to support division). Logarithm and exponentiation divide by
+// 1, 2, ..., n - 1, so for residues modulo p the series can be at most p long.
+//
+// Every function comes in two flavours: one working on polynomials, and a dense_series_* one working on dense
+// coefficient buffers (the ith element being the coefficient of x^i), which the polynomial ones are built on.
+
+// result = f^-1 mod x^n
+template<typename T>
+void dense_series_inverse(const CoefficientBuffer<T>& f, const size_t n, CoefficientBuffer<T>& result)
+{
+    result.clear();
+    if (n == 0)
+        return;
+
+    if (f.empty() || f[0] == id_additive<T>::value)
+        throw std::invalid_argument("Power series with zero constant member has no inverse.");
+
+    result.push_back(id_multiplicative<T>::value / f[0]);
+
+    CoefficientBuffer<T> product, error;
+    for (size_t m = 1; m < n; )
+    {
+        const size_t next = std::min(2 * m, n);
+
+        // If g is the inverse mod x^m, then f*g = 1 + e*x^m, and g - g*e*x^m is the inverse mod x^2m.
+        dense_multiply_truncated(f, result, next, product);
+        CoefficientBuffer<T> e(product.begin() + m, product.end());
+        dense_multiply_truncated(result, e, next - m, error);
+
+        result.resize(next, id_additive<T>::value);
+        for (size_t i = 0; i < next - m; ++i)
+            result[m + i] = id_additive<T>::value - error[i];
+
+        m = next;
+    }
+}
+
+// result = f' (the formal derivative, as a power series)
+template<typename T>
+void dense_series_derivative(const CoefficientBuffer<T>& f, CoefficientBuffer<T>& result)
+{
+    result.assign(f.empty() ? 0 : f.size() - 1, id_additive<T>::value);
+
+    T index = id_additive<T>::value;
+    for (size_t i = 1; i < f.size(); ++i)
+    {
+        index += id_multiplicative<T>::value;
+        result[i - 1] = index * f[i];
+    }
+}
+
+// result = the integral of f with zero constant member, mod x^n
+template<typename T>
+void dense_series_integral(const CoefficientBuffer<T>& f, const size_t n, CoefficientBuffer<T>& result)
+{
+    result.assign(n, id_additive<T>::value);
+
+    T index = id_additive<T>::value;
+    for (size_t i = 1; i < n && i - 1 < f.size(); ++i)
+    {
+        index += id_multiplicative<T>::value;
+        result[i] = f[i - 1] / index;
+    }
+}
+
+// result = log(f) mod x^n, where f's constant member must be 1
+template<typename T>
+void dense_series_log(const CoefficientBuffer<T>& f, const size_t n, CoefficientBuffer<T>& result)
+{
+    if (f.empty() || f[0] != id_multiplicative<T>::value)
+        throw std::invalid_argument("The logarithm is only defined for power series with constant member 1.");
+
+    if (n == 0)
+    {
+        result.clear();
+        return;
+    }
+
+    // log(f)' = f' / f
+    CoefficientBuffer<T> derivative, inverse, quotient;
+    dense_series_derivative(f, derivative);
+    dense_series_inverse(f, n - 1, inverse);
+    dense_multiply_truncated(derivative, inverse, n - 1, quotient);
+    dense_series_integral(quotient, n, result);
+}
+
+// result = exp(f) mod x^n, where f's constant member must be 0
+template<typename T>
+void dense_series_exp(const CoefficientBuffer<T>& f, const size_t n, CoefficientBuffer<T>& result)
+{
+    if (!f.empty() && f[0] != id_additive<T>::value)
+        throw std::invalid_argument("The exponential is only defined for power series with constant member 0.");
+
+    result.clear();
+    if (n == 0)
+        return;
+
+    result.push_back(id_multiplicative<T>::value);
+
+    CoefficientBuffer<T> logarithm, factor, product;
+    for (size_t m = 1; m < n; )
+    {
+        const size_t next = std::min(2 * m, n);
+
+        // g = g * (1 + f - log(g)) mod x^2m
+        dense_series_log(result, next, logarithm);
+        factor.assign(next, id_additive<T>::value);
+        for (size_t i = 0; i < next; ++i)
+            factor[i] = (i < f.size() ? f[i] - logarithm[i] : id_additive<T>::value - logarithm[i]);
+        factor[0] += id_multiplicative<T>::value;
+
+        dense_multiply_truncated(result, factor, next, product);
+        result.swap(product);
+
+        m = next;
+    }
+}
+
+// result = sqrt(f) mod x^n, the root with constant member 1 (f's constant member must be 1)
+template<typename T>
+void dense_series_sqrt(const CoefficientBuffer<T>& f, const size_t n, CoefficientBuffer<T>& result)
+{
+    if (f.empty() || f[0] != id_multiplicative<T>::value)
+        throw std::invalid_argument("The square root is only calculated for power series with constant member 1.");
+
+    result.clear();
+    if (n == 0)
+        return;
+
+    result.push_back(id_multiplicative<T>::value);
+    const T half = id_multiplicative<T>::value / (id_multiplicative<T>::value + id_multiplicative<T>::value);
+
+    CoefficientBuffer<T> inverse, quotient;
+    for (size_t m = 1; m < n; )
+    {
+        const size_t next = std::min(2 * m, n);
+
+        // g = (g + f/g) / 2 mod x^2m
+        dense_series_inverse(result, next, inverse);
+        dense_multiply_truncated(f, inverse, next, quotient);
+
+        result.resize(next, id_additive<T>::value);
+        for (size_t i = 0; i < next; ++i)
+            result[i] = (result[i] + quotient[i]) * half;
+
+        m = next;
+    }
+}
+
+// result = f^k mod x^n
+template<typename T>
+void dense_series_pow(const CoefficientBuffer<T>& f, unsigned long long k, const size_t n, CoefficientBuffer<T>& result)
+{
+    // Binary exponentiation, throwing away everything above x^n after every multiplication.
+    // (exp(k * log(f)) would need f's constant member to be 1 and k to be a coefficient.)
+    result.assign(n, id_additive<T>::value);
+    if (n == 0)
+        return;
+    result[0] = id_multiplicative<T>::value;
+
+    CoefficientBuffer<T> square(f.begin(), f.begin() + std::min(f.size(), n)), product;
+    while (k > 0)
+    {
+        if (k & 1)
+        {
+            dense_multiply_truncated(result, square, n, product);
+            result.swap(product);
+        }
+
+        k >>= 1;
+        if (k > 0)
+        {
+            dense_multiply_truncated(square, square, n, product);
+            square.swap(product);
+        }
+    }
+}
+
+/* The same on polynomials */
+// a * b mod x^n
+template<typename T>
+Polynomial<T> series_multiply(const Polynomial<T>& a, const Polynomial<T>& b, const size_t n)
+{
+    CoefficientBuffer<T> lefts, rights, result;
+    a.getCoefficients(lefts);
+    b.getCoefficients(rights);
+    dense_multiply_truncated(lefts, rights, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// f^-1 mod x^n
+template<typename T>
+Polynomial<T> series_inverse(const Polynomial<T>& f, const size_t n)
+{
+    CoefficientBuffer<T> coefficients, result;
+    f.getCoefficients(coefficients);
+    dense_series_inverse(coefficients, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// log(f) mod x^n
+template<typename T>
+Polynomial<T> series_log(const Polynomial<T>& f, const size_t n)
+{
+    CoefficientBuffer<T> coefficients, result;
+    f.getCoefficients(coefficients);
+    dense_series_log(coefficients, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// exp(f) mod x^n
+template<typename T>
+Polynomial<T> series_exp(const Polynomial<T>& f, const size_t n)
+{
+    CoefficientBuffer<T> coefficients, result;
+    f.getCoefficients(coefficients);
+    dense_series_exp(coefficients, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// sqrt(f) mod x^n
+template<typename T>
+Polynomial<T> series_sqrt(const Polynomial<T>& f, const size_t n)
+{
+    CoefficientBuffer<T> coefficients, result;
+    f.getCoefficients(coefficients);
+    dense_series_sqrt(coefficients, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+// f^k mod x^n
+template<typename T>
+Polynomial<T> series_pow(const Polynomial<T>& f, const unsigned long long k, const size_t n)
+{
+    CoefficientBuffer<T> coefficients, result;
+    f.getCoefficients(coefficients);
+    dense_series_pow(coefficients, k, n, result);
+    return Polynomial<T>(result.cbegin(), result.cend());
+}
+
+#endif // _POWER_SERIES_H
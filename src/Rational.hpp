@@ -2,8 +2,10 @@
 #define _RATIONAL_H
 
 #include <algorithm>
+#include <functional>
 #include <iosfwd>
 #include "EuclideanAlgorithm.hpp"
+#include "Instrumentation.hpp"
 
 class Rational
 {
@@ -368,6 +370,7 @@ void Rational::_simplify()
         throw std::invalid_argument(errormessage.str());
     }
 
+    POLYNOM_COUNT(simplifications, 1);
     unsigned long long gcd = euclidean<unsigned long long>(this->m_numerator, this->m_denominator);
     
     if (gcd > 1)
@@ -403,4 +406,25 @@ struct abs_value<Rational>
 };
 #endif // _ABSVALUE_WRAPPER_H
 
+// Hash rational numbers so they can be used as keys of unordered containers.
+// Non-zero rationals are always kept simplified, so equal numbers have the same representation.
+// Zero, however, might be stored as 0/n for any n, so the denominator must not be hashed for it.
+namespace std
+{
+    template<>
+    struct hash<Rational>
+    {
+        size_t operator()(const Rational& frac) const
+        {
+            size_t h = std::hash<bool>()(frac.negative());
+            if (frac.numerator() == 0)
+                return h;
+
+            h = h * 31 + std::hash<unsigned long long>()(frac.numerator());
+            h = h * 31 + std::hash<unsigned long long>()(frac.denominator());
+            return h;
+        }
+    };
+}
+
 #endif // _RATIONAL_H
\ No newline at end of file
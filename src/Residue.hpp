@@ -4,7 +4,9 @@
 #include <stdexcept>
 #include <sstream>
 #include <vector>
+#include <functional>
 #include "EuclideanAlgorithm.hpp"
+#include "Instrumentation.hpp"
 
 class Residue
 {
@@ -54,8 +56,10 @@ long Residue::multiply(const long& a, const long& b) const
 
 long Residue::calcMod(const long& a) const
 {
-    // Calculate the modulo for the given number
-    return (a % this->m_modulo + this->m_modulo) % this->m_modulo;
+    // Calculate the modulo for the given number (% keeps the sign of a, so negative ones are shifted up)
+    POLYNOM_COUNT(reductions, 1);
+    long mod = a % this->m_modulo;
+    return (mod < 0 ? mod + this->m_modulo : mod);
 }
 
 // Represent a number in a residue/congruence system
@@ -114,8 +118,14 @@ ResidueNum<M>::ResidueNum()
 template<long M>
 ResidueNum<M>::ResidueNum(const long num)
 {
-    Residue r(M);
-    this->m_number = r.calcMod(num);
+    // The results of the operators are already reduced, they don't need the (slow) division
+    if (num >= 0 && num < M)
+        this->m_number = num;
+    else
+    {
+        Residue r(M);
+        this->m_number = r.calcMod(num);
+    }
 }
 
 template<long M>
@@ -213,43 +223,38 @@ ResidueNum<M>& operator += (ResidueNum<M>& current, const ResidueNum<M>& add)
 template<long M>
 bool operator < (const ResidueNum<M>& a, const ResidueNum<M>& b)
 {
-    Residue r(M);
-    return r.calcMod(a.m_number) < r.calcMod(b.m_number);
+    // The numbers are always kept reduced into [0, M)
+    return a.m_number < b.m_number;
 }
 
 template<long M>
 bool operator <= (const ResidueNum<M>& a, const ResidueNum<M>& b)
 {
-    Residue r(M);
-    return r.calcMod(a.m_number) <= r.calcMod(b.m_number);
+    return a.m_number <= b.m_number;
 }
 
 template<long M>
 bool operator > (const ResidueNum<M>& a, const ResidueNum<M>& b)
 {
-    Residue r(M);
-    return r.calcMod(a.m_number) > r.calcMod(b.m_number);
+    return a.m_number > b.m_number;
 }
 
 template<long M>
 bool operator >= (const ResidueNum<M>& a, const ResidueNum<M>& b)
 {
-    Residue r(M);
-    return r.calcMod(a.m_number) >= r.calcMod(b.m_number);
+    return a.m_number >= b.m_number;
 }
 
 template<long M>
 bool operator == (const ResidueNum<M>& a, const ResidueNum<M>& b)
 {
-    Residue r(M);
-    return r.calcMod(a.m_number) == r.calcMod(b.m_number);
+    return a.m_number == b.m_number;
 }
 
 template<long M>
 bool operator != (const ResidueNum<M>& a, const ResidueNum<M>& b)
 {
-    Residue r(M);
-    return r.calcMod(a.m_number) != r.calcMod(b.m_number);
+    return a.m_number != b.m_number;
 }
 
 template<long M>
@@ -285,4 +290,18 @@ struct abs_value<ResidueNum<M>>
     }
 };
 #endif // _ABSVALUE_WRAPPER_H
+
+// Hash residue numbers by their representative, so they can be used as keys of unordered containers.
+// (The constructor already reduces the number into [0, M), so equal residues have equal representatives.)
+namespace std
+{
+    template<long M>
+    struct hash<ResidueNum<M>>
+    {
+        size_t operator()(const ResidueNum<M>& num) const
+        {
+            return std::hash<long>()(num.number());
+        }
+    };
+}
 #endif // _RESIDUE_H
\ No newline at end of file
@@ -0,0 +1,426 @@
+#ifndef _ROOT_FINDER_H
+#define _ROOT_FINDER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "Complex.hpp"
+#include "ThreadPool.hpp"
+
+// Numerical root finder for polynomials with real or complex coefficients (Polynomial<double>, Polynomial<Complex>...)
+//
+// Every root is approximated at the same time with the Aberth-Ehrlich iteration:
+//     z_k <- z_k - w_k,  w_k = N_k / (1 - N_k * sum_{j != k} 1 / (z_k - z_j)),  N_k = p(z_k) / p'(z_k)
+// which is Newton's method with the other approximations pushing each other away, so they don't converge
+// to the same root. (The convergence is cubic for simple roots.)
+//
+// The calculation is done on double precision numbers, with the real and imaginary parts stored in separate
+// arrays: the polynomial and its derivative are evaluated at every approximation at once, in loops over the
+// approximations, which the compiler can vectorise. Outside the unit disk the reversed polynomial is evaluated
+// at 1/z, so high-degree polynomials don't overflow.
+//
+// A root is accepted when |p(z)| is below the rounding error of the evaluation (the backward error criterion),
+// then it's left alone while the others are refined.
+
+// How the iteration went
+struct RootFinderReport
+{
+    // The number of iterations done
+    size_t iterations;
+
+    // The number of roots which met the stopping criterion
+    size_t converged;
+
+    // The largest correction of the last iteration
+    double maxCorrection;
+
+    // Whether every root converged
+    bool success;
+};
+
+class RootFinder
+{
+    public:
+        // Create a finder which gives up after the given number of iterations
+        RootFinder(const size_t maxIterations = 100);
+
+        // Find the roots of the polynomial (which must not be the nullpolynomial).
+        // Returns whether every root converged. The buffers are kept between the calls,
+        // so one finder can solve many polynomials without allocating again and again.
+        template<typename T>
+        bool solve(const Polynomial<T>& poly);
+
+        // The same, with the approximations distributed among the threads of the pool in every iteration
+        template<typename T>
+        bool solve(const Polynomial<T>& poly, ThreadPool& pool);
+
+        // The roots found by the last solve() (as many as the degree of the polynomial, with multiplicities)
+        const std::vector<Complex>& roots() const;
+
+        // The report about the last solve()
+        const RootFinderReport& report() const;
+
+    private:
+        size_t m_maxIterations;
+
+        // The coefficients, the constant member being the first
+        std::vector<double> m_re, m_im, m_abs;
+
+        // The approximations, the parts of the Newton corrections and the Aberth corrections
+        std::vector<double> m_zr, m_zi, m_nr, m_ni, m_wr, m_wi;
+        std::vector<char> m_converged;
+
+        // The scratch buffers of _newton(), as long as the approximations: a chunk [begin, end) of the
+        // approximations uses [begin, end) of them, so the threads don't share any part, and nothing is
+        // allocated in the iterations. (The indices of the approximations still moving, the points where the
+        // polynomial is evaluated, and the values, derivatives and error bounds there.)
+        std::vector<size_t> m_indices;
+        std::vector<double> m_yr, m_yi, m_ya, m_pr, m_pi, m_dr, m_di, m_b;
+
+        std::vector<Complex> m_roots;
+        RootFinderReport m_report;
+
+        template<typename T>
+        bool _solve(const Polynomial<T>& poly, ThreadPool* pool);
+
+        // Calculate the Newton corrections of the approximations in [begin, end), and accept the converged ones
+        void _newton(const size_t begin, const size_t end);
+
+        // Evaluate the polynomial (p), its derivative (d) and the bound of the rounding error (b) at the points
+        // [begin, end) with Horner's scheme (for the reversed polynomial if Reversed)
+        template<bool Reversed>
+        void _horner(const size_t begin, const size_t end, const double* yr, const double* yi, const double* ya,
+            double* pr, double* pi, double* dr, double* di, double* b) const;
+
+        // Calculate the Aberth corrections of the approximations in [begin, end)
+        void _aberth(const size_t begin, const size_t end);
+
+        // Run body(begin, end) on the chunks of the approximations, on the pool if there is one
+        template<typename F>
+        void _forChunks(ThreadPool* pool, const F& body);
+};
+
+// Get the parts of a coefficient as doubles
+inline void _complex_parts(const Complex& coefficient, double& re, double& im)
+{
+    re = static_cast<double>(coefficient.re());
+    im = static_cast<double>(coefficient.im());
+}
+
+template<typename T>
+void _complex_parts(const T& coefficient, double& re, double& im)
+{
+    re = static_cast<double>(coefficient);
+    im = 0;
+}
+
+RootFinder::RootFinder(const size_t maxIterations)
+{
+    this->m_maxIterations = maxIterations;
+    this->m_report.iterations = 0;
+    this->m_report.converged = 0;
+    this->m_report.maxCorrection = 0;
+    this->m_report.success = false;
+}
+
+template<typename T>
+bool RootFinder::solve(const Polynomial<T>& poly)
+{
+    return this->_solve(poly, nullptr);
+}
+
+template<typename T>
+bool RootFinder::solve(const Polynomial<T>& poly, ThreadPool& pool)
+{
+    return this->_solve(poly, &pool);
+}
+
+const std::vector<Complex>& RootFinder::roots() const
+{
+    return this->m_roots;
+}
+
+const RootFinderReport& RootFinder::report() const
+{
+    return this->m_report;
+}
+
+template<typename T>
+bool RootFinder::_solve(const Polynomial<T>& poly, ThreadPool* pool)
+{
+    if (poly.isNull())
+        throw std::invalid_argument("Every number is a root of the nullpolynomial.");
+
+    CoefficientBuffer<T> coefficients;
+    poly.getCoefficients(coefficients);
+
+    // x^k divides the polynomial if the lowest k coefficients are zero: those roots are exactly 0
+    size_t zeros = 0;
+    while (coefficients[zeros] == id_additive<T>::value)
+        ++zeros;
+
+    const size_t degree = coefficients.size() - 1 - zeros;
+    this->m_re.resize(degree + 1);
+    this->m_im.resize(degree + 1);
+    this->m_abs.resize(degree + 1);
+    for (size_t i = 0; i <= degree; ++i)
+    {
+        _complex_parts(coefficients[zeros + i], this->m_re[i], this->m_im[i]);
+        this->m_abs[i] = std::hypot(this->m_re[i], this->m_im[i]);
+    }
+
+    // Start from a circle whose radius is the geometric mean of the roots' absolute values.
+    // (The angles are shifted a bit, so the starting points are not symmetric to the real axis.)
+    this->m_zr.resize(degree);
+    this->m_zi.resize(degree);
+    this->m_nr.assign(degree, 0);
+    this->m_ni.assign(degree, 0);
+    this->m_wr.assign(degree, 0);
+    this->m_wi.assign(degree, 0);
+    this->m_converged.assign(degree, 0);
+    this->m_indices.resize(degree);
+    this->m_yr.resize(degree);
+    this->m_yi.resize(degree);
+    this->m_ya.resize(degree);
+    this->m_pr.resize(degree);
+    this->m_pi.resize(degree);
+    this->m_dr.resize(degree);
+    this->m_di.resize(degree);
+    this->m_b.resize(degree);
+
+    const double radius = (degree > 0 ? std::pow(this->m_abs[0] / this->m_abs[degree], 1.0 / degree) : 0);
+    const double pi = std::acos(-1.0);
+    for (size_t k = 0; k < degree; ++k)
+    {
+        const double angle = 2 * pi * k / degree + 0.4;
+        this->m_zr[k] = radius * std::cos(angle);
+        this->m_zi[k] = radius * std::sin(angle);
+    }
+
+    this->m_report.iterations = 0;
+    this->m_report.converged = 0;
+    this->m_report.maxCorrection = 0;
+
+    while (this->m_report.converged < degree && this->m_report.iterations < this->m_maxIterations)
+    {
+        ++this->m_report.iterations;
+
+        // Every correction is calculated from the old approximations before any of them is changed,
+        // so the result doesn't depend on how the work is distributed.
+        this->_forChunks(pool, [this](size_t begin, size_t end) { this->_newton(begin, end); });
+        this->_forChunks(pool, [this](size_t begin, size_t end) { this->_aberth(begin, end); });
+
+        this->m_report.converged = 0;
+        this->m_report.maxCorrection = 0;
+        for (size_t k = 0; k < degree; ++k)
+        {
+            this->m_zr[k] -= this->m_wr[k];
+            this->m_zi[k] -= this->m_wi[k];
+            this->m_report.maxCorrection = std::max(this->m_report.maxCorrection, std::hypot(this->m_wr[k], this->m_wi[k]));
+            this->m_report.converged += (this->m_converged[k] ? 1 : 0);
+        }
+    }
+    this->m_report.success = (this->m_report.converged == degree);
+
+    this->m_roots.assign(zeros, Complex());
+    for (size_t k = 0; k < degree; ++k)
+        this->m_roots.push_back(Complex(this->m_zr[k], this->m_zi[k]));
+
+    return this->m_report.success;
+}
+
+void RootFinder::_newton(const size_t begin, const size_t end)
+{
+    const size_t degree = this->m_re.size() - 1;
+
+    // The rounding error of Horner's scheme is at most about 2n * epsilon * sum |a_i| |y|^i
+    const double epsilon = 2 * (degree + 1) * std::numeric_limits<double>::epsilon();
+
+    // The approximations still moving, the ones inside the unit disk first (evaluated at z),
+    // then the ones outside of it (evaluated at y = 1/z, with the reversed polynomial)
+    size_t* indices = this->m_indices.data() + begin;
+    size_t count = 0;
+    for (size_t k = begin; k < end; ++k)
+        if (!this->m_converged[k] && this->m_zr[k] * this->m_zr[k] + this->m_zi[k] * this->m_zi[k] <= 1)
+            indices[count++] = k;
+    const size_t inside = count;
+    for (size_t k = begin; k < end; ++k)
+        if (!this->m_converged[k] && this->m_zr[k] * this->m_zr[k] + this->m_zi[k] * this->m_zi[k] > 1)
+            indices[count++] = k;
+
+    // The scratch buffers of the chunk
+    double* yr = this->m_yr.data() + begin;
+    double* yi = this->m_yi.data() + begin;
+    double* ya = this->m_ya.data() + begin;
+    double* pr = this->m_pr.data() + begin;
+    double* pi = this->m_pi.data() + begin;
+    double* dr = this->m_dr.data() + begin;
+    double* di = this->m_di.data() + begin;
+    double* b = this->m_b.data() + begin;
+
+    for (size_t k = 0; k < count; ++k)
+    {
+        const double zr = this->m_zr[indices[k]], zi = this->m_zi[indices[k]];
+        const double norm = (k < inside ? 1 : zr * zr + zi * zi);
+        yr[k] = zr / norm;
+        yi[k] = (k < inside ? zi : -zi / norm);
+        ya[k] = std::sqrt(yr[k] * yr[k] + yi[k] * yi[k]);
+    }
+
+    this->_horner<false>(0, inside, yr, yi, ya, pr, pi, dr, di, b);
+    this->_horner<true>(inside, count, yr, yi, ya, pr, pi, dr, di, b);
+
+    for (size_t index = begin; index < end; ++index)
+        if (this->m_converged[index])
+            this->m_nr[index] = this->m_ni[index] = 0;
+
+    for (size_t k = 0; k < count; ++k)
+    {
+        const size_t index = indices[k];
+
+        // Small enough to be the rounding error of the evaluation itself: this is a root.
+        // (It only gets a last Newton correction: near another approximation even a tiny one could make
+        // a big Aberth correction.)
+        if (std::sqrt(pr[k] * pr[k] + pi[k] * pi[k]) <= epsilon * b[k])
+            this->m_converged[index] = 1;
+
+        // q = p'/p at y
+        const double pn = pr[k] * pr[k] + pi[k] * pi[k];
+        double qr = (pn > 0 ? (dr[k] * pr[k] + di[k] * pi[k]) / pn : 0);
+        double qi = (pn > 0 ? (di[k] * pr[k] - dr[k] * pi[k]) / pn : 0);
+
+        if (k >= inside)
+        {
+            // p(z) = z^n * rev(p)(1/z), so p'/p (z) = y * (n - y * rev(p)'/rev(p) (y)) with y = 1/z
+            const double sr = degree - (yr[k] * qr - yi[k] * qi);
+            const double si = -(yr[k] * qi + yi[k] * qr);
+            qr = yr[k] * sr - yi[k] * si;
+            qi = yr[k] * si + yi[k] * sr;
+        }
+
+        // N = p/p' = 1/q
+        const double qn = qr * qr + qi * qi;
+        this->m_nr[index] = (qn > 0 ? qr / qn : 0);
+        this->m_ni[index] = (qn > 0 ? -qi / qn : 0);
+    }
+}
+
+// The number of points _horner() evaluates at once
+const size_t HORNER_BLOCK_POINTS = 64;
+
+template<bool Reversed>
+void RootFinder::_horner(const size_t begin, const size_t end, const double* yr, const double* yi, const double* ya,
+    double* pr, double* pi, double* dr, double* di, double* b) const
+{
+    const size_t degree = this->m_re.size() - 1;
+
+    // In blocks of points, on local arrays: the compiler can see that they don't overlap the buffers, so the loop
+    // over the points is vectorised without checking all the pairs of the arrays first
+    for (size_t first = begin; first < end; first += HORNER_BLOCK_POINTS)
+    {
+        const size_t n = std::min(end - first, HORNER_BLOCK_POINTS);
+        double vr[HORNER_BLOCK_POINTS], vi[HORNER_BLOCK_POINTS], wr[HORNER_BLOCK_POINTS], wi[HORNER_BLOCK_POINTS];
+        double e[HORNER_BLOCK_POINTS];
+        std::fill(vr, vr + n, 0.0);
+        std::fill(vi, vi + n, 0.0);
+        std::fill(wr, wr + n, 0.0);
+        std::fill(wi, wi + n, 0.0);
+        std::fill(e, e + n, 0.0);
+
+        const double* xr = yr + first;
+        const double* xi = yi + first;
+        const double* xa = ya + first;
+        for (size_t i = degree + 1; i-- > 0; )
+        {
+            const size_t c = (Reversed ? degree - i : i);
+            const double ar = this->m_re[c], ai = this->m_im[c], aa = this->m_abs[c];
+
+            // (v is p, w is p')
+            for (size_t k = 0; k < n; ++k)
+            {
+                const double nwr = wr[k] * xr[k] - wi[k] * xi[k] + vr[k];
+                const double nwi = wr[k] * xi[k] + wi[k] * xr[k] + vi[k];
+                const double nvr = vr[k] * xr[k] - vi[k] * xi[k] + ar;
+                const double nvi = vr[k] * xi[k] + vi[k] * xr[k] + ai;
+                wr[k] = nwr;
+                wi[k] = nwi;
+                vr[k] = nvr;
+                vi[k] = nvi;
+                e[k] = e[k] * xa[k] + aa;
+            }
+        }
+
+        std::copy(vr, vr + n, pr + first);
+        std::copy(vi, vi + n, pi + first);
+        std::copy(wr, wr + n, dr + first);
+        std::copy(wi, wi + n, di + first);
+        std::copy(e, e + n, b + first);
+    }
+}
+
+void RootFinder::_aberth(const size_t begin, const size_t end)
+{
+    const size_t degree = this->m_zr.size();
+
+    for (size_t k = begin; k < end; ++k)
+    {
+        if (this->m_converged[k])
+        {
+            this->m_wr[k] = this->m_nr[k];
+            this->m_wi[k] = this->m_ni[k];
+            continue;
+        }
+
+        // S = sum 1 / (z_k - z_j)
+        const double zr = this->m_zr[k], zi = this->m_zi[k];
+        double sr = 0, si = 0;
+        for (size_t j = 0; j < degree; ++j)
+        {
+            const double dr = zr - this->m_zr[j], di = zi - this->m_zi[j];
+            const double dn = dr * dr + di * di;
+            const double inverse = (j != k && dn > 0 ? 1 / dn : 0);
+            sr += dr * inverse;
+            si -= di * inverse;
+        }
+
+        // w = N / (1 - N * S)
+        const double nr = this->m_nr[k], ni = this->m_ni[k];
+        const double denr = 1 - (nr * sr - ni * si), deni = -(nr * si + ni * sr);
+        const double den = denr * denr + deni * deni;
+        if (den > 0)
+        {
+            this->m_wr[k] = (nr * denr + ni * deni) / den;
+            this->m_wi[k] = (ni * denr - nr * deni) / den;
+        }
+        else
+        {
+            this->m_wr[k] = nr;
+            this->m_wi[k] = ni;
+        }
+    }
+}
+
+template<typename F>
+void RootFinder::_forChunks(ThreadPool* pool, const F& body)
+{
+    const size_t count = this->m_zr.size();
+    if (!pool || count < 64)
+    {
+        body(0, count);
+        return;
+    }
+
+    // A few chunks per thread, so the faster threads can take more of them
+    const size_t chunks = std::min(count / 16, 4 * (pool->size() + 1));
+    pool->parallel_for(0, chunks, [&body, count, chunks](size_t chunk)
+    {
+        body(chunk * count / chunks, (chunk + 1) * count / chunks);
+    });
+}
+
+#endif // _ROOT_FINDER_H
@@ -0,0 +1,830 @@
+#ifndef _ROOT_ISOLATION_H
+#define _ROOT_ISOLATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "PolynomialGcd.hpp"
+#include "Rational.hpp"
+#include "Residue.hpp"
+
+// Isolation of the real roots of polynomials with rational coefficients: disjoint intervals with rational
+// endpoints, each containing exactly one root.
+//
+// It's the Descartes method with bisection (Collins-Akritas, also called VCA): by Descartes' rule of signs the
+// number of sign variations in the coefficients of (x+1)^n * p(1/(x+1)) is an upper bound on the number of roots
+// of p in (0, 1), exceeding it by an even number. If it's 0 or 1, the interval is done, otherwise (0, 1) is
+// halved: 2^n * p(x/2) has the roots of the left half in (0, 1), and its Taylor shift by 1 the ones of the right half.
+// The positive roots are mapped into (0, 1) first by a power of 2 above them, the negative ones are the positive
+// roots of p(-x).
+//
+// The rule only works for squarefree polynomials, so the repeated factors are divided out first. (Each root is
+// reported once.)
+//
+// The coefficients grow by about n bits in every halving, far beyond the range of Rational, so the calculation is
+// done on integers of arbitrary size. Only additions and shifts are needed: the Taylor shift by 1 is the Pascal
+// triangle of additions, and multiplications by powers of 2 are shifts.
+
+// An interval which contains exactly one real root: the open interval (lower, upper),
+// or the root itself if lower == upper
+struct RootInterval
+{
+    Rational lower;
+    Rational upper;
+};
+
+// A polynomial with integer coefficients of arbitrary size, for the Descartes method.
+// Every coefficient has the same number of 64-bit limbs (in two's complement), stored one after the other,
+// so a Taylor shift runs over one contiguous array. The width is raised before every operation which can make
+// the coefficients grow, and lowered again afterwards.
+class IsolationPolynomial
+{
+    public:
+        // The polynomial with the given rational coefficients, multiplied by their common denominator
+        IsolationPolynomial(const CoefficientBuffer<Rational>& coefficients);
+
+        size_t degree() const;
+
+        // The number of zero coefficients at the bottom (the multiplicity of the root 0)
+        size_t zeroRoots() const;
+
+        // Divide by x^k (the lowest k coefficients must be zeros)
+        void divideByPower(const size_t k);
+
+        // p(-x)
+        void negateVariable();
+
+        // p(2^k * x)
+        void scaleVariable(const size_t k);
+
+        // 2^n * p(x/2)
+        void halveVariable();
+
+        // p(x+1)
+        void shift();
+
+        // The exponent of a power of 2 above the absolute value of every root
+        size_t rootBound() const;
+
+        // The number of sign variations of (x+1)^n * p(1/(x+1)), counted up to 2
+        // (an upper bound on the number of roots in (0, 1), with the same parity)
+        size_t descartesBound() const;
+
+    private:
+        size_t m_degree;
+        size_t m_width;
+        std::vector<uint64_t> m_limbs;
+
+        // Bits needed for the sum of n + 1 numbers of the given size
+        size_t _sumBits(const size_t bits) const;
+
+        bool _isZero(const size_t i) const;
+        bool _isNegative(const size_t i) const;
+
+        // The number of bits of the absolute value of the ith coefficient
+        size_t _bitLength(const size_t i) const;
+        size_t _maxBitLength() const;
+
+        // Change the number of limbs per coefficient (keeping the values, which must fit)
+        void _setWidth(const size_t width);
+
+        // Make room for the given number of bits (and the sign)
+        void _reserveBits(const size_t bits);
+
+        // Divide by the highest power of 2 dividing every coefficient (the roots don't change)
+        // and drop the unused limbs
+        void _normalise();
+
+        // Multiply the ith coefficient by 2^bits (it must fit)
+        void _shiftLeft(const size_t i, const size_t bits);
+
+        // Multiply the ith coefficient by a number (it must fit)
+        void _multiply(const size_t i, const uint64_t factor);
+
+        // destination += source, on coefficients of the given width
+        static void _add(uint64_t* destination, const uint64_t* source, const size_t width);
+        // coefficient = -coefficient
+        static void _negate(uint64_t* coefficient, const size_t width);
+};
+
+IsolationPolynomial::IsolationPolynomial(const CoefficientBuffer<Rational>& coefficients)
+{
+    this->m_degree = coefficients.size() - 1;
+
+    // The common denominator is collected as a list of factors: every denominator is divided by the gcds with
+    // the factors so far, and the rest is a new factor. (So it divides the product, and can be divided out of it.)
+    std::vector<unsigned long long> factors;
+    for (size_t i = 0; i <= this->m_degree; ++i)
+    {
+        unsigned long long rest = coefficients[i].denominator();
+        for (size_t j = 0; j < factors.size() && rest > 1; ++j)
+            rest /= euclidean<unsigned long long>(rest, factors[j]);
+        if (rest > 1)
+            factors.push_back(rest);
+    }
+
+    // Each factor is at most 64 bits (and one more limb for the sign)
+    this->m_width = factors.size() + 2;
+    this->m_limbs.assign((this->m_degree + 1) * this->m_width, 0);
+
+    for (size_t i = 0; i <= this->m_degree; ++i)
+    {
+        uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+        const unsigned long long numerator = coefficients[i].numerator();
+        coefficient[0] = numerator;
+        if (numerator == 0)
+            continue;
+
+        // numerator * (the common denominator / the own denominator)
+        unsigned long long rest = coefficients[i].denominator();
+        for (size_t j = 0; j < factors.size(); ++j)
+        {
+            const unsigned long long common = (rest > 1 ? euclidean<unsigned long long>(rest, factors[j]) : 1);
+            const unsigned long long factor = factors[j] / common;
+            rest /= common;
+
+            this->_multiply(i, factor);
+        }
+
+        if (coefficients[i].negative())
+            _negate(coefficient, this->m_width);
+    }
+
+    this->_normalise();
+}
+
+size_t IsolationPolynomial::degree() const
+{
+    return this->m_degree;
+}
+
+size_t IsolationPolynomial::zeroRoots() const
+{
+    size_t k = 0;
+    while (k < this->m_degree && this->_isZero(k))
+        ++k;
+    return k;
+}
+
+void IsolationPolynomial::divideByPower(const size_t k)
+{
+    this->m_limbs.erase(this->m_limbs.begin(), this->m_limbs.begin() + k * this->m_width);
+    this->m_degree -= k;
+}
+
+void IsolationPolynomial::negateVariable()
+{
+    for (size_t i = 1; i <= this->m_degree; i += 2)
+        _negate(&this->m_limbs[i * this->m_width], this->m_width);
+}
+
+void IsolationPolynomial::scaleVariable(const size_t k)
+{
+    this->_reserveBits(this->_maxBitLength() + k * this->m_degree);
+    for (size_t i = 1; i <= this->m_degree; ++i)
+        this->_shiftLeft(i, k * i);
+    this->_normalise();
+}
+
+void IsolationPolynomial::halveVariable()
+{
+    this->_reserveBits(this->_maxBitLength() + this->m_degree);
+    for (size_t i = 0; i < this->m_degree; ++i)
+        this->_shiftLeft(i, this->m_degree - i);
+    this->_normalise();
+}
+
+void IsolationPolynomial::shift()
+{
+    this->_reserveBits(this->_sumBits(this->_maxBitLength() + this->m_degree));
+
+    const size_t width = this->m_width;
+    uint64_t* a = this->m_limbs.data();
+    for (size_t i = 0; i < this->m_degree; ++i)
+        for (size_t j = this->m_degree - 1; j + 1 > i; --j)
+            _add(a + j * width, a + (j + 1) * width, width);
+
+    this->_normalise();
+}
+
+size_t IsolationPolynomial::rootBound() const
+{
+    // Fujiwara's bound: |z| <= 2 * max |a_i / a_n|^(1 / (n - i)), and |a_i / a_n| < 2^(bits(a_i) - bits(a_n) + 1)
+    const long long leading = static_cast<long long>(this->_bitLength(this->m_degree));
+    long long bound = 0;
+    for (size_t i = 0; i < this->m_degree; ++i)
+    {
+        if (this->_isZero(i))
+            continue;
+
+        const long long difference = static_cast<long long>(this->_bitLength(i)) - leading + 1;
+        const long long distance = static_cast<long long>(this->m_degree - i);
+        const long long exponent = (difference > 0 ? (difference + distance - 1) / distance : -(-difference / distance));
+        bound = std::max(bound, exponent + 1);
+    }
+    return static_cast<size_t>(bound);
+}
+
+size_t IsolationPolynomial::descartesBound() const
+{
+    const size_t n = this->m_degree;
+
+    // If the signs don't change, neither do they in (x+1)^n * p(1/(x+1)) = sum a_i * (x+1)^(n-i)
+    size_t signs = 0;
+    for (size_t i = 0; i <= n; ++i)
+        if (!this->_isZero(i))
+            signs |= (this->_isNegative(i) ? 2 : 1);
+    if (signs != 3)
+        return 0;
+
+    const size_t width = (this->_sumBits(this->_maxBitLength() + n) + 1) / 64 + 1;
+
+    // The reversed coefficients, widened
+    std::vector<uint64_t> a((n + 1) * width, 0);
+    for (size_t i = 0; i <= n; ++i)
+    {
+        const uint64_t* source = &this->m_limbs[(n - i) * this->m_width];
+        const uint64_t extension = (this->_isNegative(n - i) ? ~0ULL : 0);
+        std::copy(source, source + this->m_width, &a[i * width]);
+        std::fill(&a[i * width] + this->m_width, &a[i * width] + width, extension);
+    }
+
+    // The Taylor shift finishes with the ith coefficient in the ith round, so the variations can be counted
+    // on the way, and it stops as soon as there are two of them.
+    size_t variations = 0;
+    int sign = 0;
+    for (size_t i = 0; i <= n; ++i)
+    {
+        if (i < n)
+            for (size_t j = n - 1; j + 1 > i; --j)
+                _add(&a[j * width], &a[(j + 1) * width], width);
+
+        const uint64_t* coefficient = &a[i * width];
+        if (std::all_of(coefficient, coefficient + width, [](uint64_t limb) { return limb == 0; }))
+            continue;
+
+        const int current = ((coefficient[width - 1] >> 63) ? -1 : 1);
+        if (sign != 0 && current != sign && ++variations == 2)
+            break;
+        sign = current;
+    }
+
+    return variations;
+}
+
+size_t IsolationPolynomial::_sumBits(const size_t bits) const
+{
+    size_t extra = 0;
+    while ((static_cast<size_t>(1) << extra) <= this->m_degree + 1)
+        ++extra;
+    return bits + extra;
+}
+
+bool IsolationPolynomial::_isZero(const size_t i) const
+{
+    const uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+    for (size_t l = 0; l < this->m_width; ++l)
+        if (coefficient[l] != 0)
+            return false;
+    return true;
+}
+
+bool IsolationPolynomial::_isNegative(const size_t i) const
+{
+    return (this->m_limbs[(i + 1) * this->m_width - 1] >> 63) != 0;
+}
+
+size_t IsolationPolynomial::_bitLength(const size_t i) const
+{
+    // A negative x is -(~x + 1), which has one bit more than ~x only if ~x is 2^k - 1
+    const uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+    const bool negative = this->_isNegative(i);
+    const uint64_t flip = (negative ? ~0ULL : 0);
+
+    size_t bits = 0, ones = 0;
+    for (size_t l = 0; l < this->m_width; ++l)
+    {
+        const uint64_t limb = coefficient[l] ^ flip;
+        for (uint64_t rest = limb; rest != 0; rest &= rest - 1)
+            ++ones;
+        if (limb != 0)
+        {
+            bits = 64 * l;
+            for (uint64_t rest = limb; rest != 0; rest >>= 1)
+                ++bits;
+        }
+    }
+    return (negative && ones == bits ? bits + 1 : bits);
+}
+
+size_t IsolationPolynomial::_maxBitLength() const
+{
+    size_t bits = 0;
+    for (size_t i = 0; i <= this->m_degree; ++i)
+        bits = std::max(bits, this->_bitLength(i));
+    return bits;
+}
+
+void IsolationPolynomial::_setWidth(const size_t width)
+{
+    if (width == this->m_width)
+        return;
+
+    std::vector<uint64_t> limbs((this->m_degree + 1) * width, 0);
+    for (size_t i = 0; i <= this->m_degree; ++i)
+    {
+        const uint64_t extension = (this->_isNegative(i) ? ~0ULL : 0);
+        for (size_t l = 0; l < width; ++l)
+            limbs[i * width + l] = (l < this->m_width ? this->m_limbs[i * this->m_width + l] : extension);
+    }
+
+    this->m_limbs.swap(limbs);
+    this->m_width = width;
+}
+
+void IsolationPolynomial::_reserveBits(const size_t bits)
+{
+    // One more bit for the sign
+    const size_t width = bits / 64 + 1;
+    if (width > this->m_width)
+        this->_setWidth(width);
+}
+
+void IsolationPolynomial::_normalise()
+{
+    // The lowest set bit of a number is the same as of its negative
+    size_t shift = 64 * this->m_width;
+    for (size_t i = 0; i <= this->m_degree; ++i)
+    {
+        const uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+        for (size_t l = 0; l < this->m_width && 64 * l < shift; ++l)
+            if (coefficient[l] != 0)
+            {
+                size_t zeros = 64 * l;
+                for (uint64_t limb = coefficient[l]; (limb & 1) == 0; limb >>= 1)
+                    ++zeros;
+                shift = std::min(shift, zeros);
+                break;
+            }
+    }
+
+    if (shift > 0 && shift < 64 * this->m_width)
+    {
+        const size_t limbs = shift / 64, bits = shift % 64;
+        for (size_t i = 0; i <= this->m_degree; ++i)
+        {
+            uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+            const uint64_t extension = ((coefficient[this->m_width - 1] >> 63) ? ~0ULL : 0);
+            for (size_t l = 0; l < this->m_width; ++l)
+            {
+                const uint64_t low = (l + limbs < this->m_width ? coefficient[l + limbs] : extension);
+                const uint64_t high = (l + limbs + 1 < this->m_width ? coefficient[l + limbs + 1] : extension);
+                coefficient[l] = (bits == 0 ? low : (low >> bits) | (high << (64 - bits)));
+            }
+        }
+    }
+
+    this->_setWidth(this->_maxBitLength() / 64 + 1);
+}
+
+void IsolationPolynomial::_shiftLeft(const size_t i, const size_t bits)
+{
+    uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+    const size_t limbs = bits / 64, rest = bits % 64;
+    for (size_t l = this->m_width; l-- > 0; )
+    {
+        const uint64_t high = (l >= limbs ? coefficient[l - limbs] : 0);
+        const uint64_t low = (l >= limbs + 1 ? coefficient[l - limbs - 1] : 0);
+        coefficient[l] = (rest == 0 ? high : (high << rest) | (low >> (64 - rest)));
+    }
+}
+
+void IsolationPolynomial::_multiply(const size_t i, const uint64_t factor)
+{
+    // Schoolbook multiplication on 32-bit halves, so the partial products fit into 64 bits
+    uint64_t* coefficient = &this->m_limbs[i * this->m_width];
+    const uint64_t mask = 0xFFFFFFFFULL;
+    std::vector<uint64_t> product(2 * this->m_width + 2, 0);
+    for (size_t l = 0; l < 2 * this->m_width; ++l)
+    {
+        const uint64_t half = (coefficient[l / 2] >> (32 * (l % 2))) & mask;
+        uint64_t carry = 0;
+        for (size_t f = 0; f < 2; ++f)
+        {
+            const uint64_t sum = half * ((factor >> (32 * f)) & mask) + product[l + f] + carry;
+            product[l + f] = sum & mask;
+            carry = sum >> 32;
+        }
+        for (size_t k = l + 2; carry != 0 && k < product.size(); ++k)
+        {
+            const uint64_t sum = product[k] + carry;
+            product[k] = sum & mask;
+            carry = sum >> 32;
+        }
+    }
+
+    for (size_t l = 0; l < this->m_width; ++l)
+        coefficient[l] = product[2 * l] | (product[2 * l + 1] << 32);
+}
+
+void IsolationPolynomial::_add(uint64_t* destination, const uint64_t* source, const size_t width)
+{
+    uint64_t carry = 0;
+    for (size_t l = 0; l < width; ++l)
+    {
+        const uint64_t sum = destination[l] + carry;
+        carry = (sum < carry ? 1 : 0);
+        destination[l] = sum + source[l];
+        carry += (destination[l] < sum ? 1 : 0);
+    }
+}
+
+void IsolationPolynomial::_negate(uint64_t* coefficient, const size_t width)
+{
+    uint64_t carry = 1;
+    for (size_t l = 0; l < width; ++l)
+    {
+        coefficient[l] = ~coefficient[l] + carry;
+        carry = (carry != 0 && coefficient[l] == 0 ? 1 : 0);
+    }
+}
+
+// The coefficients modulo the prime M, returns false if M divides a denominator or the leading coefficient
+template<long M>
+bool _reduce_rationals(const CoefficientBuffer<Rational>& coefficients, Polynomial<ResidueNum<M>>& reduced)
+{
+    typedef ResidueNum<M> Reduced;
+
+    if (coefficients.back().numerator() % M == 0)
+        return false;
+
+    std::vector<Reduced> residues(coefficients.size());
+    for (size_t i = 0; i < coefficients.size(); ++i)
+    {
+        const long numerator = static_cast<long>(coefficients[i].numerator() % M);
+        const long denominator = static_cast<long>(coefficients[i].denominator() % M);
+        if (denominator == 0)
+            return false;
+        residues[i] = Reduced(coefficients[i].negative() ? -numerator : numerator) / Reduced(denominator);
+    }
+
+    reduced = Polynomial<Reduced>(residues.cbegin(), residues.cend());
+    return true;
+}
+
+// The monic squarefree part of f modulo the prime M (M above the degree), as the numbers of its coefficients.
+// Returns false if f can't be reduced modulo M.
+template<long M>
+bool _modular_squarefree_part(const CoefficientBuffer<Rational>& f, std::vector<long>& part)
+{
+    Polynomial<ResidueNum<M>> g;
+    if (!_reduce_rationals(f, g))
+        return false;
+
+    Polynomial<ResidueNum<M>> reduced = g / polynomial_gcd(g, g.derive());
+    reduced = reduced / reduced.leadingCoefficient();
+
+    part.resize(reduced.degree() + 1);
+    for (size_t i = 0; i < part.size(); ++i)
+        part[i] = reduced.getMember(i).number();
+    return true;
+}
+
+// Whether s is the squarefree part of f modulo M (up to a constant factor): s divides f, and f / s divides f'.
+// (If s missed a root of f, f / s would have that root with the multiplicity it has in f, and f' with one less.)
+template<long M>
+bool _is_squarefree_part(const CoefficientBuffer<Rational>& f, const CoefficientBuffer<Rational>& s)
+{
+    Polynomial<ResidueNum<M>> a, b, quotient, remainder, rest;
+    if (!_reduce_rationals(f, a) || !_reduce_rationals(s, b))
+        return false;
+
+    a.divide(b, quotient, remainder);
+    if (!remainder.isNull())
+        return false;
+
+    a.derive().divide(quotient, rest, remainder);
+    return remainder.isNull();
+}
+
+// base^exponent mod m (m < 2^32)
+uint64_t _power_modulo(uint64_t base, uint64_t exponent, const uint64_t m)
+{
+    uint64_t result = 1;
+    for (base %= m; exponent > 0; exponent >>= 1)
+    {
+        if (exponent & 1)
+            result = result * base % m;
+        base = base * base % m;
+    }
+    return result;
+}
+
+// An unsigned 128 bit number as two 64-bit limbs, for the Chinese remainder theorem and the rational
+// reconstruction of the squarefree part (the residues are modulo the product of four 31 bit primes)
+struct WideNumber
+{
+    uint64_t low;
+    uint64_t high;
+};
+
+WideNumber _wide_number(const uint64_t value)
+{
+    WideNumber result = { value, 0 };
+    return result;
+}
+
+bool _wide_less(const WideNumber& a, const WideNumber& b)
+{
+    return a.high < b.high || (a.high == b.high && a.low < b.low);
+}
+
+WideNumber _wide_add(const WideNumber& a, const WideNumber& b)
+{
+    WideNumber result = { a.low + b.low, a.high + b.high };
+    result.high += (result.low < a.low ? 1 : 0);
+    return result;
+}
+
+WideNumber _wide_subtract(const WideNumber& a, const WideNumber& b)
+{
+    WideNumber result = { a.low - b.low, a.high - b.high };
+    result.high -= (a.low < b.low ? 1 : 0);
+    return result;
+}
+
+// a * b mod 2^128, on 32 bit halves
+WideNumber _wide_multiply(const WideNumber& a, const WideNumber& b)
+{
+    const uint64_t mask = 0xFFFFFFFFULL;
+    const uint64_t x[] = { a.low & mask, a.low >> 32, a.high & mask, a.high >> 32 };
+    const uint64_t y[] = { b.low & mask, b.low >> 32, b.high & mask, b.high >> 32 };
+
+    uint64_t product[4] = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < 4; ++i)
+    {
+        uint64_t carry = 0;
+        for (size_t j = 0; i + j < 4; ++j)
+        {
+            const uint64_t sum = x[i] * y[j] + product[i + j] + carry;
+            product[i + j] = sum & mask;
+            carry = sum >> 32;
+        }
+    }
+
+    WideNumber result = { product[0] | (product[1] << 32), product[2] | (product[3] << 32) };
+    return result;
+}
+
+// a mod m (m < 2^32)
+uint64_t _wide_remainder(const WideNumber& a, const uint64_t m)
+{
+    // 2^64 mod m, then the limbs
+    const uint64_t base = (0xFFFFFFFFFFFFFFFFULL % m + 1) % m;
+    return ((a.high % m) * base % m + a.low % m) % m;
+}
+
+// a = quotient * b + remainder (b not zero), by the binary long division
+void _wide_divide(const WideNumber& a, const WideNumber& b, WideNumber& quotient, WideNumber& remainder)
+{
+    quotient = _wide_number(0);
+    remainder = _wide_number(0);
+    for (size_t bit = 128; bit-- > 0; )
+    {
+        remainder.high = (remainder.high << 1) | (remainder.low >> 63);
+        remainder.low = (remainder.low << 1) | (((bit >= 64 ? a.high : a.low) >> (bit % 64)) & 1);
+        if (!_wide_less(remainder, b))
+        {
+            remainder = _wide_subtract(remainder, b);
+            (bit >= 64 ? quotient.high : quotient.low) |= 1ULL << (bit % 64);
+        }
+    }
+}
+
+// The fraction a/b with |a|, b <= sqrt(modulus / 2) which is congruent to residue modulo the modulus, found by
+// the extended Euclidean algorithm (Wang's rational reconstruction). Returns false if there is none.
+// (The modulus must be below 2^127.)
+bool _rational_reconstruction(const WideNumber& residue, const WideNumber& modulus, Rational& fraction)
+{
+    // The largest bound with 2 * bound^2 <= modulus, bit by bit (it's below 2^63)
+    uint64_t bound = 0;
+    for (size_t bit = 63; bit-- > 0; )
+    {
+        const WideNumber candidate = _wide_number(bound | (1ULL << bit));
+        const WideNumber square = _wide_multiply(candidate, candidate);
+        if (!_wide_less(modulus, _wide_add(square, square)))
+            bound |= 1ULL << bit;
+    }
+
+    // The remainders stay non-negative, and the signs of the t alternate: t = t0 - q * t1 is |t0| + q * |t1| in
+    // absolute value.
+    WideNumber r0 = modulus, r1 = residue, t0 = _wide_number(0), t1 = _wide_number(1), q, r;
+    bool negative = false; // The sign of t1
+    while (_wide_less(_wide_number(bound), r1))
+    {
+        _wide_divide(r0, r1, q, r);
+        const WideNumber t = _wide_add(t0, _wide_multiply(q, t1));
+        r0 = r1;
+        r1 = r;
+        t0 = t1;
+        t1 = t;
+        negative = !negative;
+    }
+
+    if (t1.high != 0 || t1.low == 0 || t1.low > bound)
+        return false;
+
+    // (The bound is below 2^63, so they fit.)
+    fraction = Rational(r1.low, t1.low, negative && (r1.low != 0));
+    return true;
+}
+
+// f / gcd(f, f'), the product of the distinct irreducible factors of f (up to a constant factor)
+Polynomial<Rational> squarefree_part(const Polynomial<Rational>& f)
+{
+    // The gcd is almost always 1, which can be seen modulo a large prime without the Rational coefficients
+    // overflowing: if it's 1 there (and the leading coefficient doesn't vanish), the discriminant isn't zero.
+    CoefficientBuffer<Rational> coefficients;
+    f.getCoefficients(coefficients);
+
+    Polynomial<ResidueNum<1000000007>> reduced;
+    if (_reduce_rationals(coefficients, reduced) && polynomial_gcd(reduced, reduced.derive()).degree() == 0)
+        return f;
+
+    // Otherwise the gcd over the rationals would overflow Rational (the coefficients of the remainders of Euclid's
+    // algorithm grow exponentially), so the monic squarefree part is calculated modulo four primes, and its
+    // coefficients are reconstructed from their residues modulo the product (which is below 2^124) as fractions.
+    // The primes where the gcd has a higher degree than the real one give a squarefree part of lower degree, so
+    // only the ones with the highest degree are used. Then the result is checked modulo two more primes.
+    const long primes[] = { 2147483647, 2147483629, 2147483587, 2147483579 };
+    std::vector<long> parts[4];
+    const bool reducible[] = {
+        _modular_squarefree_part<2147483647>(coefficients, parts[0]),
+        _modular_squarefree_part<2147483629>(coefficients, parts[1]),
+        _modular_squarefree_part<2147483587>(coefficients, parts[2]),
+        _modular_squarefree_part<2147483579>(coefficients, parts[3])
+    };
+
+    size_t length = 0;
+    for (size_t k = 0; k < 4; ++k)
+        if (reducible[k])
+            length = std::max(length, parts[k].size());
+    if (length == 0)
+        throw std::overflow_error("The squarefree part can't be calculated modulo the primes.");
+
+    // The residues of the coefficients modulo the product of the primes, combined with the Chinese remainder theorem
+    std::vector<WideNumber> residues(length, _wide_number(0));
+    WideNumber modulus = _wide_number(1);
+    for (size_t k = 0; k < 4; ++k)
+    {
+        if (!reducible[k] || parts[k].size() != length)
+            continue;
+
+        // x + modulus * ((r - x) / modulus mod p)
+        const uint64_t p = static_cast<uint64_t>(primes[k]);
+        const uint64_t inverse = _power_modulo(_wide_remainder(modulus, p), p - 2, p);
+        for (size_t i = 0; i < length; ++i)
+        {
+            const uint64_t difference = (static_cast<uint64_t>(parts[k][i]) + p - _wide_remainder(residues[i], p)) % p;
+            residues[i] = _wide_add(residues[i], _wide_multiply(modulus, _wide_number(difference * inverse % p)));
+        }
+        modulus = _wide_multiply(modulus, _wide_number(p));
+    }
+
+    CoefficientBuffer<Rational> part(length);
+    for (size_t i = 0; i < length; ++i)
+        if (!_rational_reconstruction(residues[i], modulus, part[i]))
+            throw std::overflow_error("The squarefree part is out of the range of Rational.");
+
+    if (!_is_squarefree_part<2147483563>(coefficients, part) || !_is_squarefree_part<2147483549>(coefficients, part))
+        throw std::overflow_error("The squarefree part is out of the range of Rational.");
+
+    return Polynomial<Rational>(part.cbegin(), part.cend());
+}
+
+// The endpoint c * 2^(exponent - depth) of an interval of the bisection
+Rational _dyadic_endpoint(const unsigned long long c, const size_t depth, const size_t exponent, const bool negative)
+{
+    if (exponent >= depth)
+    {
+        const size_t shift = exponent - depth;
+        if (shift >= 63 || (c >> (63 - shift)) != 0)
+            throw std::overflow_error("The isolating interval is out of the range of Rational.");
+        return Rational(c << shift, 1, negative && c != 0);
+    }
+
+    if (depth - exponent >= 63)
+        throw std::overflow_error("The isolating interval is too narrow for Rational.");
+    return Rational(c, 1ULL << (depth - exponent), negative && c != 0);
+}
+
+// Isolate the positive roots of p (squarefree, with p(0) != 0) in increasing order
+void _isolate_positive_roots(const IsolationPolynomial& p, const bool negative, std::vector<RootInterval>& intervals)
+{
+    // The intervals of the bisection are (c / 2^depth, (c + 1) / 2^depth) * 2^exponent, and the polynomials
+    // are transformed so these are mapped to (0, 1). A node with exact set is the root c / 2^depth * 2^exponent.
+    struct Node
+    {
+        IsolationPolynomial poly;
+        unsigned long long c;
+        size_t depth;
+        bool exact;
+    };
+
+    const size_t exponent = p.rootBound();
+    Node root = { p, 0, 0, false };
+    root.poly.scaleVariable(exponent);
+
+    std::vector<Node> stack(1, root);
+    while (!stack.empty())
+    {
+        Node node = std::move(stack.back());
+        stack.pop_back();
+
+        if (node.exact)
+        {
+            const Rational value = _dyadic_endpoint(node.c, node.depth, exponent, negative);
+            intervals.push_back(RootInterval{ value, value });
+            continue;
+        }
+
+        const size_t bound = node.poly.descartesBound();
+        if (bound == 0)
+            continue;
+
+        if (bound == 1)
+        {
+            const Rational lower = _dyadic_endpoint(node.c, node.depth, exponent, negative);
+            const Rational upper = _dyadic_endpoint(node.c + 1, node.depth, exponent, negative);
+            intervals.push_back(negative ? RootInterval{ upper, lower } : RootInterval{ lower, upper });
+            continue;
+        }
+
+        if (node.depth >= 62)
+            throw std::overflow_error("The isolating interval is too narrow for Rational.");
+
+        // The halves, to be processed from left to right
+        Node left = { node.poly, 2 * node.c, node.depth + 1, false };
+        left.poly.halveVariable();
+        Node right = { left.poly, 2 * node.c + 1, node.depth + 1, false };
+        right.poly.shift();
+
+        // The midpoint may be a root itself
+        const size_t zeros = right.poly.zeroRoots();
+        right.poly.divideByPower(zeros);
+
+        stack.push_back(right);
+        if (zeros > 0)
+        {
+            Node midpoint = { right.poly, 2 * node.c + 1, node.depth + 1, true };
+            stack.push_back(midpoint);
+        }
+        stack.push_back(left);
+    }
+}
+
+// Disjoint isolating intervals of the distinct real roots of f, in increasing order
+std::vector<RootInterval> isolate_real_roots(const Polynomial<Rational>& f)
+{
+    if (f.isNull())
+        throw std::invalid_argument("Every number is a root of the nullpolynomial.");
+
+    CoefficientBuffer<Rational> coefficients;
+    squarefree_part(f).getCoefficients(coefficients);
+
+    IsolationPolynomial p(coefficients);
+    const size_t zeros = p.zeroRoots();
+    p.divideByPower(zeros);
+
+    std::vector<RootInterval> intervals;
+    if (p.degree() > 0)
+    {
+        // The negative roots are the positive roots of p(-x), found in decreasing order
+        IsolationPolynomial mirrored = p;
+        mirrored.negateVariable();
+        _isolate_positive_roots(mirrored, true, intervals);
+        std::reverse(intervals.begin(), intervals.end());
+    }
+
+    if (zeros > 0)
+        intervals.push_back(RootInterval{ Rational(0), Rational(0) });
+
+    if (p.degree() > 0)
+        _isolate_positive_roots(p, false, intervals);
+
+    return intervals;
+}
+
+// The number of distinct real roots of f
+size_t count_real_roots(const Polynomial<Rational>& f)
+{
+    return isolate_real_roots(f).size();
+}
+
+#endif // _ROOT_ISOLATION_H
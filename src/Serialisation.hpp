@@ -0,0 +1,631 @@
+#ifndef _SERIALISATION_H
+#define _SERIALISATION_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include "add_mult_identity.hpp"
+#include "Polynomial.hpp"
+#include "Complex.hpp"
+#include "Rational.hpp"
+#include "Residue.hpp"
+
+// A compact binary format for Polynomial<T>, to move many polynomials between processes or to files, and the
+// streaming writer and reader of it.
+//
+// A stream starts with the bytes "PLYB" and the version of the format, then the polynomials follow each other:
+//     kind         a byte telling the type of the coefficients, and its parameters (the modulus of the residues,
+//                  the precision of the floating-point numbers), checked when it's read back
+//     layout       a byte: null, dense or sparse
+//     dense:       the degree, then every coefficient from x^degree down to x^0
+//     sparse:      the number of members and the degree, then the leading coefficient, then the other members
+//                  downwards, each as the number of zero members skipped before it and its coefficient
+// A polynomial is written densely if at least half of its members are non-zero (then the zeros take less space
+// than the powers would), sparsely otherwise.
+//
+// The numbers are written as variable-length integers (LEB128: 7 bits per byte, the high bit telling that more
+// bytes follow), so small degrees, gaps and coefficients take a byte or two:
+//     integers     the value (zigzag encoded if signed, so small negative numbers are short too)
+//     Rational     the numerator with the sign, then the denominator
+//     floating     the mantissa without its trailing zero bits with the sign, then the binary exponent,
+//                  so they are exact and independent of the machine's representation
+//     Complex      the real and the imaginary part, as floating-point numbers
+//     ResidueNum   as many bytes as M - 1 needs (little-endian), not a varint, e.g. 4 bytes for 998244353
+//
+// The writer and the reader work through a buffer of their own, so they don't allocate, and they call the
+// stream only once per SERIALISATION_BUFFER bytes. The members of a read polynomial are allocated from its
+// memory resource (see MemoryResource.hpp), one map node each, unless it's an arena.
+
+// The first bytes of a stream, and the version of the format
+const char SERIALISATION_MAGIC[4] = { 'P', 'L', 'Y', 'B' };
+const unsigned char SERIALISATION_VERSION = 1;
+
+// The size of the buffers of the writer and the reader
+const size_t SERIALISATION_BUFFER = 4096;
+
+// The kinds of coefficients
+enum SerialisedKind
+{
+    SERIALISED_UNSIGNED = 1,
+    SERIALISED_SIGNED = 2,
+    SERIALISED_FLOATING = 3,
+    SERIALISED_RATIONAL = 4,
+    SERIALISED_RESIDUE = 5,
+    SERIALISED_COMPLEX = 6
+};
+
+// The layouts of the members
+enum SerialisedLayout
+{
+    SERIALISED_NULL = 0,
+    SERIALISED_DENSE = 1,
+    SERIALISED_SPARSE = 2
+};
+
+class PolynomialWriter
+{
+    public:
+        // Write polynomials to the stream (the header of the format is written first)
+        PolynomialWriter(std::ostream& stream);
+
+        // Flushes the buffer
+        ~PolynomialWriter();
+
+        // Write a polynomial. (The bytes stay in the buffer until it is full or flushed.)
+        template<typename T>
+        void write(const Polynomial<T>& poly);
+
+        // Pass the buffered bytes to the stream, and flush it. (Check the stream for errors after this.)
+        void flush();
+
+        // The elements of the format, for the coefficient types
+        void writeByte(const unsigned char byte);
+        void writeVarint(uint64_t value);
+        // A 65 bit varint: the value and one more bit below it (a sign, say)
+        void writeTaggedVarint(uint64_t value, const bool tag);
+
+    private:
+        std::ostream& m_stream;
+        char m_buffer[SERIALISATION_BUFFER];
+        size_t m_size;
+};
+
+class PolynomialReader
+{
+    public:
+        // Read polynomials from the stream. The stream is read ahead, a buffer at a time, so it shouldn't be
+        // read from elsewhere while the reader is used.
+        PolynomialReader(std::istream& stream);
+
+        // Read the next polynomial into poly, replacing its members. Returns false (leaving poly as it was) at the
+        // end of the stream.
+        // Throws std::invalid_argument if the data is not in the format, is cut off, or has another type of
+        // coefficients than T (poly is the nullpolynomial then).
+        template<typename T>
+        bool read(Polynomial<T>& poly);
+
+        // The elements of the format, for the coefficient types (they throw at the end of the stream)
+        unsigned char readByte();
+        uint64_t readVarint();
+        uint64_t readTaggedVarint(bool& tag);
+
+    private:
+        std::istream& m_stream;
+        char m_buffer[SERIALISATION_BUFFER];
+        size_t m_position;
+        size_t m_size;
+        bool m_started;
+
+        // Read the next block of the stream into the buffer, returns false if there is no more
+        bool _fill();
+
+        // Whether another polynomial follows (the header is checked first)
+        bool _next();
+};
+
+/* The coefficient types */
+// How a coefficient type is written: writeType()/readType() write and check the kind (and its parameters),
+// write()/read() the values. Types without a specialisation can't be serialised.
+template<typename T, typename Enable = void>
+struct binary_coefficient;
+
+// x -> 2x for x >= 0, -2x - 1 for x < 0
+inline uint64_t _zigzag_encode(const int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t _zigzag_decode(const uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+template<typename T>
+struct binary_coefficient<T, typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type>
+{
+    static void writeType(PolynomialWriter& out)
+    {
+        out.writeByte(SERIALISED_UNSIGNED);
+    }
+
+    static void readType(PolynomialReader& in)
+    {
+        if (in.readByte() != SERIALISED_UNSIGNED)
+            throw std::invalid_argument("The polynomial doesn't have unsigned integer coefficients.");
+    }
+
+    static void write(PolynomialWriter& out, const T& value)
+    {
+        out.writeVarint(value);
+    }
+
+    static T read(PolynomialReader& in)
+    {
+        const uint64_t value = in.readVarint();
+        if (value > static_cast<uint64_t>(std::numeric_limits<T>::max()))
+            throw std::invalid_argument("The coefficient is out of the range of the type.");
+        return static_cast<T>(value);
+    }
+};
+
+template<typename T>
+struct binary_coefficient<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>
+{
+    static void writeType(PolynomialWriter& out)
+    {
+        out.writeByte(SERIALISED_SIGNED);
+    }
+
+    static void readType(PolynomialReader& in)
+    {
+        if (in.readByte() != SERIALISED_SIGNED)
+            throw std::invalid_argument("The polynomial doesn't have signed integer coefficients.");
+    }
+
+    static void write(PolynomialWriter& out, const T& value)
+    {
+        out.writeVarint(_zigzag_encode(value));
+    }
+
+    static T read(PolynomialReader& in)
+    {
+        const int64_t value = _zigzag_decode(in.readVarint());
+        if (value < static_cast<int64_t>(std::numeric_limits<T>::min())
+            || value > static_cast<int64_t>(std::numeric_limits<T>::max()))
+            throw std::invalid_argument("The coefficient is out of the range of the type.");
+        return static_cast<T>(value);
+    }
+};
+
+// A floating-point number is m * 2^e with an odd m: m with the sign, then e zigzag encoded. Zero, the infinities
+// and NaN are written with m = 0 and e = 0, 1 and 2.
+template<typename T>
+struct binary_coefficient<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static_assert(std::numeric_limits<T>::radix == 2 && std::numeric_limits<T>::digits <= 64,
+        "Floating-point coefficients need a binary mantissa of at most 64 bits.");
+
+    static void writeType(PolynomialWriter& out)
+    {
+        out.writeByte(SERIALISED_FLOATING);
+        out.writeByte(std::numeric_limits<T>::digits);
+    }
+
+    static void readType(PolynomialReader& in)
+    {
+        if (in.readByte() != SERIALISED_FLOATING || in.readByte() != std::numeric_limits<T>::digits)
+            throw std::invalid_argument("The polynomial doesn't have floating-point coefficients of this precision.");
+    }
+
+    static void write(PolynomialWriter& out, const T& value)
+    {
+        const bool negative = std::signbit(value);
+        if (value == 0 || std::isinf(value) || std::isnan(value))
+        {
+            out.writeTaggedVarint(0, negative);
+            out.writeVarint(value == 0 ? 0 : (std::isinf(value) ? 1 : 2));
+            return;
+        }
+
+        int exponent;
+        const T fraction = std::frexp(std::fabs(value), &exponent);
+        uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, std::numeric_limits<T>::digits));
+        exponent -= std::numeric_limits<T>::digits;
+        while ((mantissa & 1) == 0)
+        {
+            mantissa >>= 1;
+            ++exponent;
+        }
+
+        out.writeTaggedVarint(mantissa, negative);
+        out.writeVarint(_zigzag_encode(exponent));
+    }
+
+    static T read(PolynomialReader& in)
+    {
+        bool negative;
+        const uint64_t mantissa = in.readTaggedVarint(negative);
+        const uint64_t exponent = in.readVarint();
+
+        T value;
+        if (mantissa == 0)
+        {
+            if (exponent > 2)
+                throw std::invalid_argument("Invalid floating-point coefficient.");
+            value = (exponent == 0 ? static_cast<T>(0)
+                : (exponent == 1 ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::quiet_NaN()));
+        }
+        else
+        {
+            if (std::numeric_limits<T>::digits < 64 && (mantissa >> (std::numeric_limits<T>::digits % 64)) != 0)
+                throw std::invalid_argument("Invalid floating-point coefficient.");
+            value = std::ldexp(static_cast<T>(mantissa), static_cast<int>(_zigzag_decode(exponent)));
+        }
+
+        return (negative ? -value : value);
+    }
+};
+
+template<>
+struct binary_coefficient<Rational>
+{
+    static void writeType(PolynomialWriter& out)
+    {
+        out.writeByte(SERIALISED_RATIONAL);
+    }
+
+    static void readType(PolynomialReader& in)
+    {
+        if (in.readByte() != SERIALISED_RATIONAL)
+            throw std::invalid_argument("The polynomial doesn't have rational coefficients.");
+    }
+
+    static void write(PolynomialWriter& out, const Rational& value)
+    {
+        out.writeTaggedVarint(value.numerator(), value.negative());
+        out.writeVarint(value.denominator());
+    }
+
+    static Rational read(PolynomialReader& in)
+    {
+        bool negative;
+        const uint64_t numerator = in.readTaggedVarint(negative);
+        const uint64_t denominator = in.readVarint();
+        if (denominator == 0)
+            throw std::invalid_argument("Invalid rational coefficient: the denominator is zero.");
+        return Rational(numerator, denominator, negative);
+    }
+};
+
+// The number of bytes value needs
+constexpr size_t _byte_width(const uint64_t value)
+{
+    return (value < 256 ? 1 : 1 + _byte_width(value >> 8));
+}
+
+template<long M>
+struct binary_coefficient<ResidueNum<M>>
+{
+    static const size_t width = _byte_width(static_cast<uint64_t>(M - 1));
+
+    static void writeType(PolynomialWriter& out)
+    {
+        out.writeByte(SERIALISED_RESIDUE);
+        out.writeVarint(static_cast<uint64_t>(M));
+    }
+
+    static void readType(PolynomialReader& in)
+    {
+        if (in.readByte() != SERIALISED_RESIDUE || in.readVarint() != static_cast<uint64_t>(M))
+            throw std::invalid_argument("The polynomial doesn't have residue coefficients of this modulus.");
+    }
+
+    static void write(PolynomialWriter& out, const ResidueNum<M>& value)
+    {
+        uint64_t number = static_cast<uint64_t>(value.number());
+        for (size_t i = 0; i < width; ++i, number >>= 8)
+            out.writeByte(static_cast<unsigned char>(number & 0xFF));
+    }
+
+    static ResidueNum<M> read(PolynomialReader& in)
+    {
+        uint64_t number = 0;
+        for (size_t i = 0; i < width; ++i)
+            number |= static_cast<uint64_t>(in.readByte()) << (8 * i);
+        if (number >= static_cast<uint64_t>(M))
+            throw std::invalid_argument("Invalid residue coefficient: it is not below the modulus.");
+        return ResidueNum<M>(static_cast<long>(number));
+    }
+};
+
+template<>
+struct binary_coefficient<Complex>
+{
+    static void writeType(PolynomialWriter& out)
+    {
+        out.writeByte(SERIALISED_COMPLEX);
+        out.writeByte(std::numeric_limits<long double>::digits);
+    }
+
+    static void readType(PolynomialReader& in)
+    {
+        if (in.readByte() != SERIALISED_COMPLEX || in.readByte() != std::numeric_limits<long double>::digits)
+            throw std::invalid_argument("The polynomial doesn't have complex coefficients of this precision.");
+    }
+
+    static void write(PolynomialWriter& out, const Complex& value)
+    {
+        binary_coefficient<long double>::write(out, value.re());
+        binary_coefficient<long double>::write(out, value.im());
+    }
+
+    static Complex read(PolynomialReader& in)
+    {
+        const long double re = binary_coefficient<long double>::read(in);
+        const long double im = binary_coefficient<long double>::read(in);
+        return Complex(re, im);
+    }
+};
+
+/* The polynomials */
+template<typename T>
+struct polynomial_serialiser
+{
+    static void write(PolynomialWriter& out, const Polynomial<T>& poly)
+    {
+        binary_coefficient<T>::writeType(out);
+        if (poly.isNull())
+        {
+            out.writeByte(SERIALISED_NULL);
+            return;
+        }
+
+        // The members are in the map from the highest power down
+        const size_t members = poly.m_coefficients.size();
+        const size_t degree = poly.degree();
+        if (2 * members >= degree + 1)
+        {
+            out.writeByte(SERIALISED_DENSE);
+            out.writeVarint(degree);
+
+            size_t next = degree + 1;
+            for (typename Polynomial<T>::coefficientsMap::const_iterator cit = poly.m_coefficients.cbegin();
+                cit != poly.m_coefficients.cend(); ++cit)
+            {
+                for (size_t power = next; power-- > cit->first + 1;)
+                    binary_coefficient<T>::write(out, id_additive<T>::value);
+                binary_coefficient<T>::write(out, cit->second);
+                next = cit->first;
+            }
+            for (size_t power = next; power-- > 0;)
+                binary_coefficient<T>::write(out, id_additive<T>::value);
+        }
+        else
+        {
+            out.writeByte(SERIALISED_SPARSE);
+            out.writeVarint(members);
+            out.writeVarint(degree);
+
+            size_t previous = degree + 1;
+            for (typename Polynomial<T>::coefficientsMap::const_iterator cit = poly.m_coefficients.cbegin();
+                cit != poly.m_coefficients.cend(); ++cit)
+            {
+                if (cit->first != degree)
+                    out.writeVarint(previous - cit->first - 1);
+                binary_coefficient<T>::write(out, cit->second);
+                previous = cit->first;
+            }
+        }
+    }
+
+    static void read(PolynomialReader& in, Polynomial<T>& poly)
+    {
+        poly.m_coefficients.clear();
+        poly.m_degree = 0;
+
+        try
+        {
+            binary_coefficient<T>::readType(in);
+            const unsigned char layout = in.readByte();
+            if (layout == SERIALISED_DENSE)
+            {
+                const uint64_t degree = in.readVarint();
+                if (degree >= std::numeric_limits<size_t>::max())
+                    throw std::invalid_argument("Invalid polynomial: the degree is too high.");
+
+                poly.m_degree = static_cast<size_t>(degree);
+                for (size_t power = poly.m_degree + 1; power-- > 0;)
+                {
+                    const T coefficient = binary_coefficient<T>::read(in);
+                    if (coefficient != id_additive<T>::value)
+                        poly.m_coefficients.emplace_hint(poly.m_coefficients.end(), power, coefficient);
+                    else if (power == poly.m_degree)
+                        throw std::invalid_argument("Invalid polynomial: the leading coefficient is zero.");
+                }
+            }
+            else if (layout == SERIALISED_SPARSE)
+            {
+                const uint64_t members = in.readVarint();
+                const uint64_t degree = in.readVarint();
+                if (degree >= std::numeric_limits<size_t>::max() || members == 0 || members > degree + 1)
+                    throw std::invalid_argument("Invalid polynomial: wrong number of members.");
+
+                poly.m_degree = static_cast<size_t>(degree);
+                size_t power = poly.m_degree;
+                for (uint64_t k = 0; k < members; ++k)
+                {
+                    if (k > 0)
+                    {
+                        const uint64_t skipped = in.readVarint();
+                        if (skipped >= power)
+                            throw std::invalid_argument("Invalid polynomial: the powers are out of order.");
+                        power -= static_cast<size_t>(skipped) + 1;
+                    }
+
+                    const T coefficient = binary_coefficient<T>::read(in);
+                    if (coefficient == id_additive<T>::value)
+                        throw std::invalid_argument("Invalid polynomial: a member of the sparse layout is zero.");
+                    poly.m_coefficients.emplace_hint(poly.m_coefficients.end(), power, coefficient);
+                }
+            }
+            else if (layout != SERIALISED_NULL)
+                throw std::invalid_argument("Invalid polynomial: unknown layout.");
+        }
+        catch (...)
+        {
+            poly.m_coefficients.clear();
+            poly.m_degree = 0;
+            throw;
+        }
+    }
+};
+
+/* Writer */
+PolynomialWriter::PolynomialWriter(std::ostream& stream)
+    : m_stream(stream), m_size(0)
+{
+    for (size_t i = 0; i < sizeof(SERIALISATION_MAGIC); ++i)
+        this->writeByte(static_cast<unsigned char>(SERIALISATION_MAGIC[i]));
+    this->writeByte(SERIALISATION_VERSION);
+}
+
+PolynomialWriter::~PolynomialWriter()
+{
+    this->flush();
+}
+
+template<typename T>
+void PolynomialWriter::write(const Polynomial<T>& poly)
+{
+    polynomial_serialiser<T>::write(*this, poly);
+}
+
+void PolynomialWriter::flush()
+{
+    this->m_stream.write(this->m_buffer, static_cast<std::streamsize>(this->m_size));
+    this->m_stream.flush();
+    this->m_size = 0;
+}
+
+void PolynomialWriter::writeByte(const unsigned char byte)
+{
+    if (this->m_size == SERIALISATION_BUFFER)
+    {
+        this->m_stream.write(this->m_buffer, static_cast<std::streamsize>(this->m_size));
+        this->m_size = 0;
+    }
+    this->m_buffer[this->m_size++] = static_cast<char>(byte);
+}
+
+void PolynomialWriter::writeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        this->writeByte(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    this->writeByte(static_cast<unsigned char>(value));
+}
+
+void PolynomialWriter::writeTaggedVarint(uint64_t value, const bool tag)
+{
+    // The first byte has the tag and 6 bits of the value
+    const unsigned char first = static_cast<unsigned char>(((value & 0x3F) << 1) | (tag ? 1 : 0));
+    value >>= 6;
+    if (value == 0)
+        this->writeByte(first);
+    else
+    {
+        this->writeByte(first | 0x80);
+        this->writeVarint(value);
+    }
+}
+
+/* Reader */
+PolynomialReader::PolynomialReader(std::istream& stream)
+    : m_stream(stream), m_position(0), m_size(0), m_started(false)
+{
+}
+
+template<typename T>
+bool PolynomialReader::read(Polynomial<T>& poly)
+{
+    if (!this->_next())
+        return false;
+
+    polynomial_serialiser<T>::read(*this, poly);
+    return true;
+}
+
+unsigned char PolynomialReader::readByte()
+{
+    if (this->m_position == this->m_size && !this->_fill())
+        throw std::invalid_argument("Unexpected end of the serialised polynomials.");
+    return static_cast<unsigned char>(this->m_buffer[this->m_position++]);
+}
+
+uint64_t PolynomialReader::readVarint()
+{
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        const unsigned char byte = this->readByte();
+        if (shift == 63 && byte > 1)
+            throw std::invalid_argument("Invalid varint: it doesn't fit in 64 bits.");
+
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+    throw std::invalid_argument("Invalid varint: it doesn't fit in 64 bits.");
+}
+
+uint64_t PolynomialReader::readTaggedVarint(bool& tag)
+{
+    const unsigned char first = this->readByte();
+    tag = (first & 1) != 0;
+    uint64_t value = (first >> 1) & 0x3F;
+    if (first & 0x80)
+    {
+        const uint64_t rest = this->readVarint();
+        if (rest >> 58 != 0)
+            throw std::invalid_argument("Invalid varint: it doesn't fit in 64 bits.");
+        value |= rest << 6;
+    }
+    return value;
+}
+
+bool PolynomialReader::_fill()
+{
+    this->m_stream.read(this->m_buffer, static_cast<std::streamsize>(SERIALISATION_BUFFER));
+    this->m_size = static_cast<size_t>(this->m_stream.gcount());
+    this->m_position = 0;
+    return this->m_size > 0;
+}
+
+bool PolynomialReader::_next()
+{
+    if (this->m_position == this->m_size && !this->_fill())
+        return false;
+
+    if (!this->m_started)
+    {
+        for (size_t i = 0; i < sizeof(SERIALISATION_MAGIC); ++i)
+            if (this->readByte() != static_cast<unsigned char>(SERIALISATION_MAGIC[i]))
+                throw std::invalid_argument("The stream doesn't contain serialised polynomials.");
+        if (this->readByte() != SERIALISATION_VERSION)
+            throw std::invalid_argument("Unsupported version of the serialisation format.");
+        this->m_started = true;
+
+        return this->_next();
+    }
+
+    return true;
+}
+
+#endif // _SERIALISATION_H
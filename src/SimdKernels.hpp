@@ -0,0 +1,801 @@
+#ifndef _SIMD_KERNELS_H
+#define _SIMD_KERNELS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "add_mult_identity.hpp"
+#include "Instrumentation.hpp"
+
+// Coefficient-wise kernels on dense coefficient arrays: sums, differences, scaling and the multiply-adds of the
+// schoolbook multiplication and the long division (see DenseMultiplication.hpp and Polynomial.hpp), and for
+// residues the element-wise products of the batches (see PolynomialBatch.hpp).
+//
+// For float, double and ResidueNum<M> the kernels use AVX2 or AVX-512 if the processor has them, selected at
+// runtime, so the same binary runs everywhere. Every other type (and every other processor or compiler) gets the
+// plain loops. The vectorised kernels calculate exactly what the plain loops do (the multiply-adds are a
+// multiplication and an addition, not fused into one instruction with a single rounding, and they skip the
+// zero elements like the loops, so 0 * inf doesn't turn a sum into NaN), so the results don't depend on the
+// machine. (Unless the compiler fuses the plain loops: GCC does that by default when it may use FMA
+// instructions, e.g. with -march=native, which is why the POLYNOM_NATIVE build adds -ffp-contract=off.)
+//
+// Residues are reduced with Montgomery's method: the scalar factor is converted to the Montgomery form once
+// per call, then every product is reduced with two 32 x 32 bit multiplications, a shift and a subtraction,
+// which the vector units can do (unlike the division by M). This works for odd moduli below 2^31; the other
+// residues use the plain loops.
+//
+// Defining POLYNOM_NO_SIMD (before including any header of the library) turns the vectorised kernels off.
+
+#if !defined(POLYNOM_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define _POLYNOM_SIMD_X86
+#include <immintrin.h>
+#endif
+
+template<long M> class ResidueNum;
+
+// The instruction sets the kernels can use, from the slowest
+enum SimdLevel
+{
+    SIMD_SCALAR = 0,
+    SIMD_AVX2 = 1,
+    SIMD_AVX512 = 2
+};
+
+// The best level the processor supports
+SimdLevel simd_supported_level();
+
+// The level the kernels use: the supported one, unless limited with set_simd_level() (e.g. to compare them)
+SimdLevel simd_level();
+void set_simd_level(const SimdLevel level);
+
+std::atomic<int>& _simdLevelSetting()
+{
+    static std::atomic<int> level(simd_supported_level());
+    return level;
+}
+
+SimdLevel simd_supported_level()
+{
+#ifdef _POLYNOM_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SIMD_AVX2;
+#endif
+    return SIMD_SCALAR;
+}
+
+SimdLevel simd_level()
+{
+    return static_cast<SimdLevel>(_simdLevelSetting().load(std::memory_order_relaxed));
+}
+
+void set_simd_level(const SimdLevel level)
+{
+    const SimdLevel supported = simd_supported_level();
+    _simdLevelSetting().store(level < supported ? level : supported, std::memory_order_relaxed);
+}
+
+// The kernels of a type: the plain loops. (The multiply-adds skip the zero elements, which pays off for
+// expensive types like Rational.)
+template<typename T>
+struct simd_kernels
+{
+    // result[i] = a[i] + b[i] and a[i] - b[i] (result can be a or b)
+    static void add(const T* a, const T* b, T* result, const size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            result[i] = a[i] + b[i];
+        POLYNOM_COUNT(additions, n);
+    }
+
+    static void subtract(const T* a, const T* b, T* result, const size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            result[i] = a[i] - b[i];
+        POLYNOM_COUNT(additions, n);
+    }
+
+    // result[i] = a[i] * c (result can be a)
+    static void scale(const T* a, const T& c, T* result, const size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            result[i] = a[i] * c;
+        POLYNOM_COUNT(multiplications, n);
+    }
+
+    // result[i] = result[i] + a[i] * c and result[i] - a[i] * c
+    static void multiplyAdd(const T* a, const T& c, T* result, const size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (a[i] == id_additive<T>::value) continue;
+
+            result[i] = result[i] + a[i] * c;
+            POLYNOM_COUNT(multiplications, 1);
+            POLYNOM_COUNT(additions, 1);
+        }
+    }
+
+    static void multiplySubtract(const T* a, const T& c, T* result, const size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (a[i] == id_additive<T>::value) continue;
+
+            result[i] = result[i] - a[i] * c;
+            POLYNOM_COUNT(multiplications, 1);
+            POLYNOM_COUNT(additions, 1);
+        }
+    }
+};
+
+#ifdef _POLYNOM_SIMD_X86
+/* float and double: the same operations on 8 (or 16) floats and 4 (or 8) doubles at once. (The multiply-adds
+   keep the old sum in the lanes where a is zero, see _simd_floating_kernels::_multiplyAdd.) */
+__attribute__((target("avx2"))) void _simd_add_avx2(const double* a, const double* b, double* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] + b[i];
+}
+
+__attribute__((target("avx2"))) void _simd_subtract_avx2(const double* a, const double* b, double* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(result + i, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] - b[i];
+}
+
+__attribute__((target("avx2"))) void _simd_scale_avx2(const double* a, const double c, double* result, const size_t n)
+{
+    const __m256d factor = _mm256_set1_pd(c);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        _mm256_storeu_pd(result + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), factor));
+    for (; i < n; ++i)
+        result[i] = a[i] * c;
+}
+
+__attribute__((target("avx2"))) void _simd_multiply_add_avx2(const double* a, const double c, double* result,
+    const size_t n, const bool subtract)
+{
+    const __m256d factor = _mm256_set1_pd(c);
+    const __m256d zero = _mm256_setzero_pd();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256d x = _mm256_loadu_pd(a + i);
+        const __m256d product = _mm256_mul_pd(x, factor);
+        const __m256d sum = _mm256_loadu_pd(result + i);
+        const __m256d updated = (subtract ? _mm256_sub_pd(sum, product) : _mm256_add_pd(sum, product));
+        _mm256_storeu_pd(result + i, _mm256_blendv_pd(updated, sum, _mm256_cmp_pd(x, zero, _CMP_EQ_OQ)));
+    }
+    for (; i < n; ++i)
+    {
+        if (a[i] == 0) continue;
+        result[i] = (subtract ? result[i] - a[i] * c : result[i] + a[i] * c);
+    }
+}
+
+
+__attribute__((target("avx2"))) void _simd_add_avx2(const float* a, const float* b, float* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(result + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] + b[i];
+}
+
+__attribute__((target("avx2"))) void _simd_subtract_avx2(const float* a, const float* b, float* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(result + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] - b[i];
+}
+
+__attribute__((target("avx2"))) void _simd_scale_avx2(const float* a, const float c, float* result, const size_t n)
+{
+    const __m256 factor = _mm256_set1_ps(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(result + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), factor));
+    for (; i < n; ++i)
+        result[i] = a[i] * c;
+}
+
+__attribute__((target("avx2"))) void _simd_multiply_add_avx2(const float* a, const float c, float* result,
+    const size_t n, const bool subtract)
+{
+    const __m256 factor = _mm256_set1_ps(c);
+    const __m256 zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 x = _mm256_loadu_ps(a + i);
+        const __m256 product = _mm256_mul_ps(x, factor);
+        const __m256 sum = _mm256_loadu_ps(result + i);
+        const __m256 updated = (subtract ? _mm256_sub_ps(sum, product) : _mm256_add_ps(sum, product));
+        _mm256_storeu_ps(result + i, _mm256_blendv_ps(updated, sum, _mm256_cmp_ps(x, zero, _CMP_EQ_OQ)));
+    }
+    for (; i < n; ++i)
+    {
+        if (a[i] == 0) continue;
+        result[i] = (subtract ? result[i] - a[i] * c : result[i] + a[i] * c);
+    }
+}
+
+
+__attribute__((target("avx512f"))) void _simd_add_avx512(const double* a, const double* b, double* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(result + i, _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] + b[i];
+}
+
+__attribute__((target("avx512f"))) void _simd_subtract_avx512(const double* a, const double* b, double* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(result + i, _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] - b[i];
+}
+
+__attribute__((target("avx512f"))) void _simd_scale_avx512(const double* a, const double c, double* result, const size_t n)
+{
+    const __m512d factor = _mm512_set1_pd(c);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm512_storeu_pd(result + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), factor));
+    for (; i < n; ++i)
+        result[i] = a[i] * c;
+}
+
+__attribute__((target("avx512f"))) void _simd_multiply_add_avx512(const double* a, const double c, double* result,
+    const size_t n, const bool subtract)
+{
+    const __m512d factor = _mm512_set1_pd(c);
+    const __m512d zero = _mm512_setzero_pd();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512d x = _mm512_loadu_pd(a + i);
+        const __mmask8 nonzero = _mm512_cmp_pd_mask(x, zero, _CMP_NEQ_UQ);
+        const __m512d product = _mm512_mul_pd(x, factor);
+        const __m512d sum = _mm512_loadu_pd(result + i);
+        _mm512_storeu_pd(result + i,
+            subtract ? _mm512_mask_sub_pd(sum, nonzero, sum, product) : _mm512_mask_add_pd(sum, nonzero, sum, product));
+    }
+    for (; i < n; ++i)
+    {
+        if (a[i] == 0) continue;
+        result[i] = (subtract ? result[i] - a[i] * c : result[i] + a[i] * c);
+    }
+}
+
+
+__attribute__((target("avx512f"))) void _simd_add_avx512(const float* a, const float* b, float* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(result + i, _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] + b[i];
+}
+
+__attribute__((target("avx512f"))) void _simd_subtract_avx512(const float* a, const float* b, float* result, const size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(result + i, _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    for (; i < n; ++i)
+        result[i] = a[i] - b[i];
+}
+
+__attribute__((target("avx512f"))) void _simd_scale_avx512(const float* a, const float c, float* result, const size_t n)
+{
+    const __m512 factor = _mm512_set1_ps(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(result + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), factor));
+    for (; i < n; ++i)
+        result[i] = a[i] * c;
+}
+
+__attribute__((target("avx512f"))) void _simd_multiply_add_avx512(const float* a, const float c, float* result,
+    const size_t n, const bool subtract)
+{
+    const __m512 factor = _mm512_set1_ps(c);
+    const __m512 zero = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m512 x = _mm512_loadu_ps(a + i);
+        const __mmask16 nonzero = _mm512_cmp_ps_mask(x, zero, _CMP_NEQ_UQ);
+        const __m512 product = _mm512_mul_ps(x, factor);
+        const __m512 sum = _mm512_loadu_ps(result + i);
+        _mm512_storeu_ps(result + i,
+            subtract ? _mm512_mask_sub_ps(sum, nonzero, sum, product) : _mm512_mask_add_ps(sum, nonzero, sum, product));
+    }
+    for (; i < n; ++i)
+    {
+        if (a[i] == 0) continue;
+        result[i] = (subtract ? result[i] - a[i] * c : result[i] + a[i] * c);
+    }
+}
+
+#endif // _POLYNOM_SIMD_X86
+
+// float and double: the vectorised loops of the best available level
+template<typename T>
+struct _simd_floating_kernels
+{
+    static void add(const T* a, const T* b, T* result, const size_t n)
+    {
+        POLYNOM_COUNT(additions, n);
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = simd_level();
+        if (level == SIMD_AVX512)
+            return _simd_add_avx512(a, b, result, n);
+        if (level == SIMD_AVX2)
+            return _simd_add_avx2(a, b, result, n);
+#endif
+        for (size_t i = 0; i < n; ++i)
+            result[i] = a[i] + b[i];
+    }
+
+    static void subtract(const T* a, const T* b, T* result, const size_t n)
+    {
+        POLYNOM_COUNT(additions, n);
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = simd_level();
+        if (level == SIMD_AVX512)
+            return _simd_subtract_avx512(a, b, result, n);
+        if (level == SIMD_AVX2)
+            return _simd_subtract_avx2(a, b, result, n);
+#endif
+        for (size_t i = 0; i < n; ++i)
+            result[i] = a[i] - b[i];
+    }
+
+    static void scale(const T* a, const T& c, T* result, const size_t n)
+    {
+        POLYNOM_COUNT(multiplications, n);
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = simd_level();
+        if (level == SIMD_AVX512)
+            return _simd_scale_avx512(a, c, result, n);
+        if (level == SIMD_AVX2)
+            return _simd_scale_avx2(a, c, result, n);
+#endif
+        for (size_t i = 0; i < n; ++i)
+            result[i] = a[i] * c;
+    }
+
+    static void multiplyAdd(const T* a, const T& c, T* result, const size_t n)
+    {
+        _multiplyAdd(a, c, result, n, false);
+    }
+
+    static void multiplySubtract(const T* a, const T& c, T* result, const size_t n)
+    {
+        _multiplyAdd(a, c, result, n, true);
+    }
+
+    // The zero elements of a are skipped, like the plain loops do: they leave the result as it is even if c is
+    // infinite or NaN (or the result is -0).
+    static void _multiplyAdd(const T* a, const T& c, T* result, const size_t n, const bool subtract)
+    {
+#ifdef POLYNOM_INSTRUMENTATION
+        const size_t products = n - static_cast<size_t>(std::count(a, a + n, static_cast<T>(0)));
+        POLYNOM_COUNT(multiplications, products);
+        POLYNOM_COUNT(additions, products);
+#endif
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = simd_level();
+        if (level == SIMD_AVX512)
+            return _simd_multiply_add_avx512(a, c, result, n, subtract);
+        if (level == SIMD_AVX2)
+            return _simd_multiply_add_avx2(a, c, result, n, subtract);
+#endif
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (a[i] == 0) continue;
+            result[i] = (subtract ? result[i] - a[i] * c : result[i] + a[i] * c);
+        }
+    }
+};
+
+template<> struct simd_kernels<double> : _simd_floating_kernels<double> {};
+template<> struct simd_kernels<float> : _simd_floating_kernels<float> {};
+
+/* Residues */
+// M^-1 mod 2^32 for an odd M, with Newton's iteration: every step doubles the correct bits of x (m itself is
+// its own inverse mod 8, so four steps are enough)
+constexpr uint32_t _odd_inverse(const uint32_t m, const uint32_t x, const int steps)
+{
+    return (steps == 0 ? x : _odd_inverse(m, x * (2u - m * x), steps - 1));
+}
+
+// -M^-1 mod 2^32, the constant of Montgomery's reduction
+constexpr uint32_t _montgomery_inverse(const uint32_t m)
+{
+    return 0u - _odd_inverse(m, m, 4);
+}
+
+// The scalar steps of the kernels: (a +- b) mod M, and a * c (+ r) mod M
+template<long M>
+ResidueNum<M> _residue_add(const ResidueNum<M>& a, const ResidueNum<M>& b, const bool subtract)
+{
+    const long r = (subtract ? a.number() - b.number() : a.number() + b.number());
+    return ResidueNum<M>(r < 0 ? r + M : (r >= M ? r - M : r));
+}
+
+template<long M>
+ResidueNum<M> _residue_multiply(const ResidueNum<M>& a, const long c, const ResidueNum<M>& r, const bool accumulate)
+{
+    // (The product is reduced before the sum, like r + a * c on the residues does)
+    const long product = a.number() * c % M;
+    if (!accumulate)
+        return ResidueNum<M>(product);
+    const long sum = r.number() + product;
+    return ResidueNum<M>(sum >= M ? sum - M : sum);
+}
+
+// t / 2^32 mod M for t < M * 2^32 (Montgomery's reduction, see the vector kernels)
+template<long M>
+long _montgomery_reduce(const uint64_t t)
+{
+    const uint32_t q = static_cast<uint32_t>(t) * _montgomery_inverse(static_cast<uint32_t>(M));
+    const uint64_t r = (t + static_cast<uint64_t>(q) * static_cast<uint64_t>(M)) >> 32;
+    return static_cast<long>(r >= static_cast<uint64_t>(M) ? r - M : r);
+}
+
+// base +- a * b for the element-wise kernels, b in Montgomery form (base can be null for 0)
+template<long M>
+ResidueNum<M> _residue_element(const ResidueNum<M>* base, const ResidueNum<M>& a, const ResidueNum<M>& b,
+    const bool subtract)
+{
+    const ResidueNum<M> product(_montgomery_reduce<M>(static_cast<uint64_t>(a.number()) * b.number()));
+    return (base ? _residue_add(*base, product, subtract) : product);
+}
+
+#ifdef _POLYNOM_SIMD_X86
+// The lanes hold residues in [0, 2M) in their lower halves (M < 2^31); x - M wraps around in the upper half if
+// x < M, so the unsigned minimum of the 32 bit halves of x and x - M is x mod M.
+// (A ResidueNum<M> is just a long in [0, M), so the lanes are loaded from and stored to the residues directly:
+// the vector types may alias anything.)
+template<long M>
+__attribute__((target("avx2"))) void _simd_residue_add_avx2(const ResidueNum<M>* a, const ResidueNum<M>* b,
+    ResidueNum<M>* result, const size_t n, const bool subtract)
+{
+    const __m256i modulo = _mm256_set1_epi64x(M);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i r;
+        if (subtract)
+        {
+            // a - b is in (-M, M): adding M brings the negatives (the wrapped ones) to range
+            r = _mm256_sub_epi64(x, y);
+            r = _mm256_min_epu32(r, _mm256_add_epi64(r, modulo));
+        }
+        else
+        {
+            r = _mm256_add_epi64(x, y);
+            r = _mm256_min_epu32(r, _mm256_sub_epi64(r, modulo));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), r);
+    }
+    for (; i < n; ++i)
+        result[i] = _residue_add(a[i], b[i], subtract);
+}
+
+// result[i] = a[i] * c (+ result[i], if accumulate), with c in Montgomery form (c * 2^32 mod M)
+template<long M>
+__attribute__((target("avx2"))) void _simd_residue_multiply_avx2(const ResidueNum<M>* a, const long c,
+    const long montgomery, ResidueNum<M>* result, const size_t n, const bool accumulate)
+{
+    const __m256i modulo = _mm256_set1_epi64x(M);
+    const __m256i inverse = _mm256_set1_epi64x(_montgomery_inverse(static_cast<uint32_t>(M)));
+    const __m256i factor = _mm256_set1_epi64x(montgomery);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        // t = a * c * 2^32, q = -t / M mod 2^32, so t + q * M is divisible by 2^32, and the quotient is a * c mod M
+        // (in [0, 2M))
+        const __m256i t = _mm256_mul_epu32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), factor);
+        const __m256i q = _mm256_mul_epu32(t, inverse);
+        __m256i r = _mm256_srli_epi64(_mm256_add_epi64(t, _mm256_mul_epu32(q, modulo)), 32);
+        r = _mm256_min_epu32(r, _mm256_sub_epi64(r, modulo));
+        if (accumulate)
+        {
+            r = _mm256_add_epi64(r, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(result + i)));
+            r = _mm256_min_epu32(r, _mm256_sub_epi64(r, modulo));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), r);
+    }
+    for (; i < n; ++i)
+        result[i] = _residue_multiply(a[i], c, result[i], accumulate);
+}
+
+// result[i] = base[i] + a[i] * b[i] (or base[i] - a[i] * b[i]; base can be null for 0), b in Montgomery form
+template<long M>
+__attribute__((target("avx2"))) void _simd_residue_elements_avx2(const ResidueNum<M>* base, const ResidueNum<M>* a,
+    const ResidueNum<M>* b, ResidueNum<M>* result, const size_t n, const bool subtract)
+{
+    const __m256i modulo = _mm256_set1_epi64x(M);
+    const __m256i inverse = _mm256_set1_epi64x(_montgomery_inverse(static_cast<uint32_t>(M)));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256i t = _mm256_mul_epu32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        const __m256i q = _mm256_mul_epu32(t, inverse);
+        __m256i r = _mm256_srli_epi64(_mm256_add_epi64(t, _mm256_mul_epu32(q, modulo)), 32);
+        r = _mm256_min_epu32(r, _mm256_sub_epi64(r, modulo));
+        if (base)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i));
+            if (subtract)
+            {
+                r = _mm256_sub_epi64(x, r);
+                r = _mm256_min_epu32(r, _mm256_add_epi64(r, modulo));
+            }
+            else
+            {
+                r = _mm256_add_epi64(x, r);
+                r = _mm256_min_epu32(r, _mm256_sub_epi64(r, modulo));
+            }
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), r);
+    }
+    for (; i < n; ++i)
+        result[i] = _residue_element(base ? base + i : nullptr, a[i], b[i], subtract);
+}
+
+// (GCC 12 warns about the placeholder arguments of its own AVX-512 intrinsics, which are never read)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+template<long M>
+__attribute__((target("avx512f"))) void _simd_residue_add_avx512(const ResidueNum<M>* a, const ResidueNum<M>* b,
+    ResidueNum<M>* result, const size_t n, const bool subtract)
+{
+    const __m512i modulo = _mm512_set1_epi64(M);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512i x = _mm512_loadu_si512(a + i);
+        const __m512i y = _mm512_loadu_si512(b + i);
+        __m512i r;
+        if (subtract)
+        {
+            r = _mm512_sub_epi64(x, y);
+            r = _mm512_min_epu32(r, _mm512_add_epi64(r, modulo));
+        }
+        else
+        {
+            r = _mm512_add_epi64(x, y);
+            r = _mm512_min_epu32(r, _mm512_sub_epi64(r, modulo));
+        }
+        _mm512_storeu_si512(result + i, r);
+    }
+    for (; i < n; ++i)
+        result[i] = _residue_add(a[i], b[i], subtract);
+}
+
+template<long M>
+__attribute__((target("avx512f"))) void _simd_residue_multiply_avx512(const ResidueNum<M>* a, const long c,
+    const long montgomery, ResidueNum<M>* result, const size_t n, const bool accumulate)
+{
+    const __m512i modulo = _mm512_set1_epi64(M);
+    const __m512i inverse = _mm512_set1_epi64(_montgomery_inverse(static_cast<uint32_t>(M)));
+    const __m512i factor = _mm512_set1_epi64(montgomery);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512i t = _mm512_mul_epu32(_mm512_loadu_si512(a + i), factor);
+        const __m512i q = _mm512_mul_epu32(t, inverse);
+        __m512i r = _mm512_srli_epi64(_mm512_add_epi64(t, _mm512_mul_epu32(q, modulo)), 32);
+        r = _mm512_min_epu32(r, _mm512_sub_epi64(r, modulo));
+        if (accumulate)
+        {
+            r = _mm512_add_epi64(r, _mm512_loadu_si512(result + i));
+            r = _mm512_min_epu32(r, _mm512_sub_epi64(r, modulo));
+        }
+        _mm512_storeu_si512(result + i, r);
+    }
+    for (; i < n; ++i)
+        result[i] = _residue_multiply(a[i], c, result[i], accumulate);
+}
+
+template<long M>
+__attribute__((target("avx512f"))) void _simd_residue_elements_avx512(const ResidueNum<M>* base,
+    const ResidueNum<M>* a, const ResidueNum<M>* b, ResidueNum<M>* result, const size_t n, const bool subtract)
+{
+    const __m512i modulo = _mm512_set1_epi64(M);
+    const __m512i inverse = _mm512_set1_epi64(_montgomery_inverse(static_cast<uint32_t>(M)));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512i t = _mm512_mul_epu32(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        const __m512i q = _mm512_mul_epu32(t, inverse);
+        __m512i r = _mm512_srli_epi64(_mm512_add_epi64(t, _mm512_mul_epu32(q, modulo)), 32);
+        r = _mm512_min_epu32(r, _mm512_sub_epi64(r, modulo));
+        if (base)
+        {
+            const __m512i x = _mm512_loadu_si512(base + i);
+            if (subtract)
+            {
+                r = _mm512_sub_epi64(x, r);
+                r = _mm512_min_epu32(r, _mm512_add_epi64(r, modulo));
+            }
+            else
+            {
+                r = _mm512_add_epi64(x, r);
+                r = _mm512_min_epu32(r, _mm512_sub_epi64(r, modulo));
+            }
+        }
+        _mm512_storeu_si512(result + i, r);
+    }
+    for (; i < n; ++i)
+        result[i] = _residue_element(base ? base + i : nullptr, a[i], b[i], subtract);
+}
+#pragma GCC diagnostic pop
+#endif // _POLYNOM_SIMD_X86
+
+template<long M>
+struct simd_kernels<ResidueNum<M>>
+{
+    // Whether the vectorised Montgomery reduction works for M (the lanes are the residues themselves)
+    static const bool vectorised = (M % 2 == 1 && M > 2 && static_cast<unsigned long long>(M) < (1ULL << 31)
+        && sizeof(long) == 8 && sizeof(ResidueNum<M>) == sizeof(long) && std::is_standard_layout<ResidueNum<M>>::value);
+
+    static void add(const ResidueNum<M>* a, const ResidueNum<M>* b, ResidueNum<M>* result, const size_t n)
+    {
+        _add(a, b, result, n, false);
+    }
+
+    static void subtract(const ResidueNum<M>* a, const ResidueNum<M>* b, ResidueNum<M>* result, const size_t n)
+    {
+        _add(a, b, result, n, true);
+    }
+
+    static void scale(const ResidueNum<M>* a, const ResidueNum<M>& c, ResidueNum<M>* result, const size_t n)
+    {
+        _multiply(a, c.number(), result, n, false);
+    }
+
+    static void multiplyAdd(const ResidueNum<M>* a, const ResidueNum<M>& c, ResidueNum<M>* result, const size_t n)
+    {
+        _multiply(a, c.number(), result, n, true);
+    }
+
+    // r - a * c = r + a * (M - c)
+    static void multiplySubtract(const ResidueNum<M>* a, const ResidueNum<M>& c, ResidueNum<M>* result, const size_t n)
+    {
+        _multiply(a, (c.number() == 0 ? 0 : M - c.number()), result, n, true);
+    }
+
+    // The element-wise products, for the lanes of the batches (see PolynomialBatch.hpp): the factors b are
+    // prepared once (into the Montgomery form, if the modulus is vectorised), then
+    //     result[i] = base[i] + a[i] * b[i]   (or base[i] - a[i] * b[i]; base can be null for 0)
+    // (result can be base or a)
+    static void prepareFactors(const ResidueNum<M>* values, ResidueNum<M>* prepared, const size_t n)
+    {
+        if (vectorised)
+            _multiply(values, static_cast<long>((1ULL << 32) % static_cast<unsigned long long>(M)), prepared, n, false);
+        else
+            std::copy(values, values + n, prepared);
+    }
+
+    static void multiplyElements(const ResidueNum<M>* base, const ResidueNum<M>* a, const ResidueNum<M>* b,
+        ResidueNum<M>* result, const size_t n, const bool subtract)
+    {
+        POLYNOM_COUNT(multiplications, n);
+        POLYNOM_COUNT(additions, base ? n : 0);
+        POLYNOM_COUNT(reductions, n);
+        if (!vectorised)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                const ResidueNum<M> product(a[i].number() * b[i].number() % M);
+                result[i] = (base ? _residue_add(base[i], product, subtract) : product);
+            }
+            return;
+        }
+
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = simd_level();
+        if (level == SIMD_AVX512)
+            return _simd_residue_elements_avx512<M>(base, a, b, result, n, subtract);
+        if (level == SIMD_AVX2)
+            return _simd_residue_elements_avx2<M>(base, a, b, result, n, subtract);
+#endif
+        for (size_t i = 0; i < n; ++i)
+            result[i] = _residue_element(base ? base + i : nullptr, a[i], b[i], subtract);
+    }
+
+    static void _add(const ResidueNum<M>* a, const ResidueNum<M>* b, ResidueNum<M>* result, const size_t n,
+        const bool subtract)
+    {
+        POLYNOM_COUNT(additions, n);
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = (vectorised ? simd_level() : SIMD_SCALAR);
+        if (level == SIMD_AVX512)
+            return _simd_residue_add_avx512<M>(a, b, result, n, subtract);
+        if (level == SIMD_AVX2)
+            return _simd_residue_add_avx2<M>(a, b, result, n, subtract);
+#endif
+        for (size_t i = 0; i < n; ++i)
+            result[i] = _residue_add(a[i], b[i], subtract);
+    }
+
+    static void _multiply(const ResidueNum<M>* a, const long c, ResidueNum<M>* result, const size_t n,
+        const bool accumulate)
+    {
+        POLYNOM_COUNT(multiplications, n);
+        POLYNOM_COUNT(additions, accumulate ? n : 0);
+        POLYNOM_COUNT(reductions, n);
+#ifdef _POLYNOM_SIMD_X86
+        const SimdLevel level = (vectorised ? simd_level() : SIMD_SCALAR);
+        if (level != SIMD_SCALAR)
+        {
+            const long montgomery = static_cast<long>((static_cast<uint64_t>(c) << 32) % static_cast<uint64_t>(M));
+            if (level == SIMD_AVX512)
+                return _simd_residue_multiply_avx512<M>(a, c, montgomery, result, n, accumulate);
+            return _simd_residue_multiply_avx2<M>(a, c, montgomery, result, n, accumulate);
+        }
+#endif
+        for (size_t i = 0; i < n; ++i)
+            result[i] = _residue_multiply(a[i], c, result[i], accumulate);
+    }
+};
+
+// The kernels as functions
+template<typename T>
+void simd_add(const T* a, const T* b, T* result, const size_t n)
+{
+    simd_kernels<T>::add(a, b, result, n);
+}
+
+template<typename T>
+void simd_subtract(const T* a, const T* b, T* result, const size_t n)
+{
+    simd_kernels<T>::subtract(a, b, result, n);
+}
+
+template<typename T>
+void simd_scale(const T* a, const T& c, T* result, const size_t n)
+{
+    simd_kernels<T>::scale(a, c, result, n);
+}
+
+template<typename T>
+void simd_multiply_add(const T* a, const T& c, T* result, const size_t n)
+{
+    simd_kernels<T>::multiplyAdd(a, c, result, n);
+}
+
+template<typename T>
+void simd_multiply_subtract(const T* a, const T& c, T* result, const size_t n)
+{
+    simd_kernels<T>::multiplySubtract(a, c, result, n);
+}
+
+#endif // _SIMD_KERNELS_H
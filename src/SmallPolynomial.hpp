@@ -0,0 +1,371 @@
+#ifndef _SMALL_POLYNOMIAL_H
+#define _SMALL_POLYNOMIAL_H
+
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include "add_mult_identity.hpp"
+#include "Instrumentation.hpp"
+#include "Polynomial.hpp"
+
+// Polynomials of degree at most N, with the coefficients stored inline (in an array of N + 1 elements), so
+// they never allocate. Polynomial<T> keeps a map node for every member; for a polynomial like 3x^2 + 4x - 9 the
+// allocations cost more than the arithmetic.
+//
+// The loops of the arithmetic go over the whole capacity, and they are unrolled at compile time, so for small N
+// they compile to straight-line code. (Zero coefficients above the degree are calculated too, it's cheaper than
+// branching on them.) The product of a degree N and a degree M polynomial is of degree N + M, so its capacity is
+// known at compile time as well, and it can't overflow.
+//
+// SmallPolynomial converts to and from Polynomial<T>. The conversion from a Polynomial throws if its degree is
+// above N; everything else never throws, except the division by the nullpolynomial.
+
+// Calls body(i) for every i in [Begin, End), with the loop unrolled at compile time
+template<size_t Begin, size_t End>
+struct _unrolled_for
+{
+    template<typename F>
+    static void run(const F& body)
+    {
+        body(Begin);
+        _unrolled_for<Begin + 1, End>::run(body);
+    }
+};
+
+template<size_t End>
+struct _unrolled_for<End, End>
+{
+    template<typename F>
+    static void run(const F&)
+    {
+    }
+};
+
+template<typename T, size_t N>
+class SmallPolynomial
+{
+    public:
+        // The highest degree the polynomial can have
+        static const size_t capacity = N;
+
+        // The nullpolynomial, a constant, or the coefficients in [first, last) (the ith being the coefficient of
+        // x^i, at most N + 1 of them)
+        SmallPolynomial<T, N>();
+        SmallPolynomial<T, N>(const T& constant);
+        template<typename InputIterator>
+        SmallPolynomial<T, N>(InputIterator first, InputIterator last);
+
+        // Conversion from and to Polynomial<T>
+        explicit SmallPolynomial<T, N>(const Polynomial<T>& poly);
+        operator Polynomial<T>() const;
+
+        template<typename U, size_t P>
+        friend SmallPolynomial<U, P> operator + (const SmallPolynomial<U, P>& a, const SmallPolynomial<U, P>& b);
+        template<typename U, size_t P>
+        friend SmallPolynomial<U, P> operator - (const SmallPolynomial<U, P>& a, const SmallPolynomial<U, P>& b);
+        template<typename U, size_t P>
+        friend SmallPolynomial<U, P> operator - (const SmallPolynomial<U, P>& a);
+        template<typename U, size_t P, size_t Q>
+        friend SmallPolynomial<U, P + Q> operator * (const SmallPolynomial<U, P>& a, const SmallPolynomial<U, Q>& b);
+
+        // Multiplication and division by a scalar
+        template<typename U, size_t P>
+        friend SmallPolynomial<U, P> operator * (const SmallPolynomial<U, P>& a, const typename polynomial_scalar<U>::type& c);
+        template<typename U, size_t P>
+        friend SmallPolynomial<U, P> operator * (const typename polynomial_scalar<U>::type& c, const SmallPolynomial<U, P>& a);
+        template<typename U, size_t P>
+        friend SmallPolynomial<U, P> operator / (const SmallPolynomial<U, P>& a, const typename polynomial_scalar<U>::type& c);
+
+        template<typename U, size_t P>
+        friend bool operator == (const SmallPolynomial<U, P>& a, const SmallPolynomial<U, P>& b);
+        template<typename U, size_t P>
+        friend bool operator != (const SmallPolynomial<U, P>& a, const SmallPolynomial<U, P>& b);
+
+        // Get the degree (0 for the nullpolynomial, like for Polynomial<T>)
+        size_t degree() const;
+
+        // Get the leading coefficient
+        T leadingCoefficient() const;
+
+        // Get the nth coefficient (zero above the capacity) and the same with []
+        T getMember(const size_t index) const;
+        T operator [] (const size_t index) const;
+
+        // Set the nth coefficient (throws if index is above the capacity)
+        void setMember(const size_t index, const T& coefficient);
+
+        // Calculate the polynomial function's value for variable 't' (with Horner's rule)
+        T at(const T& t) const;
+
+        // Algebraic derivative
+        SmallPolynomial<T, N> derive() const;
+
+        // Division with remainder, like Polynomial<T>::divide() (the coefficients must be from a field).
+        // Returns false if the divisor is the nullpolynomial.
+        bool divide(const SmallPolynomial<T, N>& divisor, SmallPolynomial<T, N>& quotient,
+            SmallPolynomial<T, N>& remainder) const;
+
+        // Get if every coefficient is zero
+        bool isNull() const;
+
+    private:
+        // The ith element is the coefficient of x^i
+        T m_coefficients[N + 1];
+};
+
+template<typename T, size_t N>
+SmallPolynomial<T, N>::SmallPolynomial()
+{
+    _unrolled_for<0, N + 1>::run([this](size_t i)
+    {
+        this->m_coefficients[i] = id_additive<T>::value;
+    });
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N>::SmallPolynomial(const T& constant)
+    : SmallPolynomial<T, N>()
+{
+    this->m_coefficients[0] = constant;
+}
+
+template<typename T, size_t N>
+template<typename InputIterator>
+SmallPolynomial<T, N>::SmallPolynomial(InputIterator first, InputIterator last)
+    : SmallPolynomial<T, N>()
+{
+    for (size_t i = 0; first != last; ++first, ++i)
+        this->setMember(i, *first);
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N>::SmallPolynomial(const Polynomial<T>& poly)
+    : SmallPolynomial<T, N>()
+{
+    if (poly.degree() > N)
+        throw std::invalid_argument("The degree of the polynomial is above the capacity of the small polynomial.");
+
+    for (size_t i = 0; i <= poly.degree(); ++i)
+        this->m_coefficients[i] = poly.getMember(i);
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N>::operator Polynomial<T>() const
+{
+    return Polynomial<T>(this->m_coefficients, this->m_coefficients + N + 1);
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> operator + (const SmallPolynomial<T, N>& a, const SmallPolynomial<T, N>& b)
+{
+    SmallPolynomial<T, N> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        result.m_coefficients[i] = a.m_coefficients[i] + b.m_coefficients[i];
+    });
+    POLYNOM_COUNT(additions, N + 1);
+    return result;
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> operator - (const SmallPolynomial<T, N>& a, const SmallPolynomial<T, N>& b)
+{
+    SmallPolynomial<T, N> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        result.m_coefficients[i] = a.m_coefficients[i] - b.m_coefficients[i];
+    });
+    POLYNOM_COUNT(additions, N + 1);
+    return result;
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> operator - (const SmallPolynomial<T, N>& a)
+{
+    SmallPolynomial<T, N> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        result.m_coefficients[i] = id_additive<T>::value - a.m_coefficients[i];
+    });
+    return result;
+}
+
+template<typename T, size_t N, size_t M>
+SmallPolynomial<T, N + M> operator * (const SmallPolynomial<T, N>& a, const SmallPolynomial<T, M>& b)
+{
+    // Schoolbook, every product of the coefficients
+    SmallPolynomial<T, N + M> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        _unrolled_for<0, M + 1>::run([&](size_t j)
+        {
+            result.m_coefficients[i + j] = result.m_coefficients[i + j] + a.m_coefficients[i] * b.m_coefficients[j];
+        });
+    });
+    POLYNOM_COUNT(multiplications, (N + 1) * (M + 1));
+    POLYNOM_COUNT(additions, (N + 1) * (M + 1));
+    return result;
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> operator * (const SmallPolynomial<T, N>& a, const typename polynomial_scalar<T>::type& c)
+{
+    SmallPolynomial<T, N> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        result.m_coefficients[i] = a.m_coefficients[i] * c;
+    });
+    POLYNOM_COUNT(multiplications, N + 1);
+    return result;
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> operator * (const typename polynomial_scalar<T>::type& c, const SmallPolynomial<T, N>& a)
+{
+    SmallPolynomial<T, N> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        result.m_coefficients[i] = c * a.m_coefficients[i];
+    });
+    POLYNOM_COUNT(multiplications, N + 1);
+    return result;
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> operator / (const SmallPolynomial<T, N>& a, const typename polynomial_scalar<T>::type& c)
+{
+    SmallPolynomial<T, N> result;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        result.m_coefficients[i] = a.m_coefficients[i] / c;
+    });
+    POLYNOM_COUNT(multiplications, N + 1);
+    return result;
+}
+
+template<typename T, size_t N>
+bool operator == (const SmallPolynomial<T, N>& a, const SmallPolynomial<T, N>& b)
+{
+    bool equal = true;
+    _unrolled_for<0, N + 1>::run([&](size_t i)
+    {
+        equal = equal && a.m_coefficients[i] == b.m_coefficients[i];
+    });
+    return equal;
+}
+
+template<typename T, size_t N>
+bool operator != (const SmallPolynomial<T, N>& a, const SmallPolynomial<T, N>& b)
+{
+    return !(a == b);
+}
+
+// Printing, the same way as Polynomial<T> (this one allocates, it's not for the fast paths)
+template<typename T, size_t N>
+std::ostream& operator << (std::ostream& o, const SmallPolynomial<T, N>& poly)
+{
+    return o << static_cast<Polynomial<T>>(poly);
+}
+
+template<typename T, size_t N>
+size_t SmallPolynomial<T, N>::degree() const
+{
+    for (size_t i = N; i > 0; --i)
+        if (this->m_coefficients[i] != id_additive<T>::value)
+            return i;
+    return 0;
+}
+
+template<typename T, size_t N>
+T SmallPolynomial<T, N>::leadingCoefficient() const
+{
+    return this->m_coefficients[this->degree()];
+}
+
+template<typename T, size_t N>
+T SmallPolynomial<T, N>::getMember(const size_t index) const
+{
+    return (index <= N ? this->m_coefficients[index] : id_additive<T>::value);
+}
+
+template<typename T, size_t N>
+T SmallPolynomial<T, N>::operator [] (const size_t index) const
+{
+    return this->getMember(index);
+}
+
+template<typename T, size_t N>
+void SmallPolynomial<T, N>::setMember(const size_t index, const T& coefficient)
+{
+    if (index > N)
+        throw std::invalid_argument("The power is above the capacity of the small polynomial.");
+    this->m_coefficients[index] = coefficient;
+}
+
+template<typename T, size_t N>
+T SmallPolynomial<T, N>::at(const T& t) const
+{
+    // Horner's rule from the top of the capacity (the zero coefficients above the degree don't change the value)
+    T result = this->m_coefficients[N];
+    _unrolled_for<0, N>::run([&](size_t i)
+    {
+        result = result * t + this->m_coefficients[N - 1 - i];
+    });
+    POLYNOM_COUNT(multiplications, N);
+    POLYNOM_COUNT(additions, N);
+    return result;
+}
+
+template<typename T, size_t N>
+SmallPolynomial<T, N> SmallPolynomial<T, N>::derive() const
+{
+    // f1 + 2*f2x + 3*f3x^2 + ..., the multipliers counted up in T
+    SmallPolynomial<T, N> derivative;
+    T index = id_additive<T>::value;
+    _unrolled_for<1, N + 1>::run([&](size_t i)
+    {
+        index = index + id_multiplicative<T>::value;
+        derivative.m_coefficients[i - 1] = index * this->m_coefficients[i];
+    });
+    POLYNOM_COUNT(multiplications, N);
+    return derivative;
+}
+
+template<typename T, size_t N>
+bool SmallPolynomial<T, N>::divide(const SmallPolynomial<T, N>& divisor, SmallPolynomial<T, N>& quotient,
+    SmallPolynomial<T, N>& remainder) const
+{
+    if (divisor.isNull())
+        return false;
+
+    // The degrees are only known at runtime, so this is the usual long division on the arrays
+    const size_t m = divisor.degree();
+    const T leading = divisor.m_coefficients[m];
+    SmallPolynomial<T, N> work = *this, result;
+    for (size_t i = work.degree() + 1; i-- > m; )
+    {
+        // (Like the map-based division, nothing is done for the zero members)
+        if (work.m_coefficients[i] == id_additive<T>::value)
+            continue;
+
+        const T factor = work.m_coefficients[i] / leading;
+        result.m_coefficients[i - m] = factor;
+        for (size_t j = 0; j < m; ++j)
+            work.m_coefficients[i - m + j] = work.m_coefficients[i - m + j] - factor * divisor.m_coefficients[j];
+        work.m_coefficients[i] = id_additive<T>::value;
+        POLYNOM_COUNT(multiplications, m + 1);
+        POLYNOM_COUNT(additions, m);
+    }
+
+    quotient = result;
+    remainder = work;
+    return true;
+}
+
+template<typename T, size_t N>
+bool SmallPolynomial<T, N>::isNull() const
+{
+    return this->degree() == 0 && this->m_coefficients[0] == id_additive<T>::value;
+}
+
+#endif // _SMALL_POLYNOMIAL_H
@@ -0,0 +1,349 @@
+#ifndef _SPLIT_COMPLEX_POLYNOMIAL_H
+#define _SPLIT_COMPLEX_POLYNOMIAL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "add_mult_identity.hpp"
+#include "DenseMultiplication.hpp"
+#include "Instrumentation.hpp"
+#include "MemoryResource.hpp"
+#include "Polynomial.hpp"
+#include "Complex.hpp"
+#include "SimdKernels.hpp"
+
+// Polynomials with complex coefficients, stored densely as two arrays: the real parts and the imaginary parts.
+//
+// Complex wraps std::complex<long double>, which is 32 bytes per coefficient (plus a map node in Polynomial<T>),
+// and whose arithmetic runs on the x87 unit on x86, one number at a time. SplitComplexPolynomial<R> keeps the
+// parts as R, double by default (16 bytes per coefficient), or long double for the precision of Complex. Every
+// complex operation is done on the real arrays:
+//     (ar + i*ai) * (br + i*bi) = (ar*br - ai*bi) + i*(ar*bi + ai*br)
+// so the products are four real polynomial products, which use Karatsuba's method and the vectorised kernels
+// of DenseMultiplication.hpp and SimdKernels.hpp, and the evaluation at many points runs over the points in
+// the innermost loop, which the compiler can vectorise.
+//
+// The results are rounded differently from the same operations on Polynomial<Complex> (and with double parts,
+// at a lower precision).
+
+template<typename R = double>
+class SplitComplexPolynomial
+{
+    public:
+        // The nullpolynomial
+        SplitComplexPolynomial<R>();
+
+        // A copy of a Polynomial<Complex> (with its parts rounded to R)
+        explicit SplitComplexPolynomial<R>(const Polynomial<Complex>& poly);
+
+        // From the parts of the coefficients, the constant member's being the first (the shorter one is padded with zeros)
+        SplitComplexPolynomial<R>(const std::vector<R>& real, const std::vector<R>& imag);
+
+        // The degree (0 for the nullpolynomial, like Polynomial<T>), and whether it is the nullpolynomial
+        size_t degree() const;
+        bool isNull() const;
+
+        // Get or set the nth coefficient
+        Complex getMember(const size_t index) const;
+        void setMember(const size_t index, const Complex& value);
+
+        // The real and imaginary parts of the coefficients, degree() + 1 of them (none for the nullpolynomial)
+        const R* real() const;
+        const R* imag() const;
+
+        // The value at t, with Horner's rule
+        Complex at(const Complex& t) const;
+
+        // The values at many points, given by their parts: values[k] = p(points[k]). The Horner steps of all
+        // points are done together, so the loop over them can be vectorised.
+        void evaluate(const std::vector<R>& pointsReal, const std::vector<R>& pointsImag,
+            std::vector<R>& valuesReal, std::vector<R>& valuesImag) const;
+
+        // Algebraic derivative
+        SplitComplexPolynomial<R> derive() const;
+
+        // Arithmetical methods
+        void add(const SplitComplexPolynomial<R>& poly);
+        void subtract(const SplitComplexPolynomial<R>& poly);
+        void multiply(const SplitComplexPolynomial<R>& poly);
+
+        // Conversion to a Polynomial<Complex>
+        operator Polynomial<Complex>() const;
+
+        template<typename S>
+        friend bool operator == (const SplitComplexPolynomial<S>& a, const SplitComplexPolynomial<S>& b);
+
+    private:
+        // The parts of the coefficients, both as long as the polynomial (the leading coefficient is not zero)
+        CoefficientBuffer<R> m_real, m_imag;
+
+        // Drop the zero coefficients from the top
+        void _trim();
+};
+
+template<typename R>
+SplitComplexPolynomial<R>::SplitComplexPolynomial()
+{
+}
+
+template<typename R>
+SplitComplexPolynomial<R>::SplitComplexPolynomial(const Polynomial<Complex>& poly)
+{
+    if (poly.isNull())
+        return;
+
+    this->m_real.assign(poly.degree() + 1, id_additive<R>::value);
+    this->m_imag.assign(poly.degree() + 1, id_additive<R>::value);
+    for (size_t i = 0; i <= poly.degree(); ++i)
+    {
+        const Complex coefficient = poly.getMember(i);
+        this->m_real[i] = static_cast<R>(coefficient.re());
+        this->m_imag[i] = static_cast<R>(coefficient.im());
+    }
+    this->_trim();
+}
+
+template<typename R>
+SplitComplexPolynomial<R>::SplitComplexPolynomial(const std::vector<R>& real, const std::vector<R>& imag)
+{
+    const size_t length = std::max(real.size(), imag.size());
+    this->m_real.assign(length, id_additive<R>::value);
+    this->m_imag.assign(length, id_additive<R>::value);
+    std::copy(real.cbegin(), real.cend(), this->m_real.begin());
+    std::copy(imag.cbegin(), imag.cend(), this->m_imag.begin());
+    this->_trim();
+}
+
+template<typename R>
+size_t SplitComplexPolynomial<R>::degree() const
+{
+    return (this->m_real.empty() ? 0 : this->m_real.size() - 1);
+}
+
+template<typename R>
+bool SplitComplexPolynomial<R>::isNull() const
+{
+    return this->m_real.empty();
+}
+
+template<typename R>
+Complex SplitComplexPolynomial<R>::getMember(const size_t index) const
+{
+    if (index >= this->m_real.size())
+        return id_additive<Complex>::value;
+    return Complex(this->m_real[index], this->m_imag[index]);
+}
+
+template<typename R>
+void SplitComplexPolynomial<R>::setMember(const size_t index, const Complex& value)
+{
+    if (index >= this->m_real.size())
+    {
+        if (value == id_additive<Complex>::value)
+            return;
+        this->m_real.resize(index + 1, id_additive<R>::value);
+        this->m_imag.resize(index + 1, id_additive<R>::value);
+    }
+
+    this->m_real[index] = static_cast<R>(value.re());
+    this->m_imag[index] = static_cast<R>(value.im());
+    this->_trim();
+}
+
+template<typename R>
+const R* SplitComplexPolynomial<R>::real() const
+{
+    return this->m_real.data();
+}
+
+template<typename R>
+const R* SplitComplexPolynomial<R>::imag() const
+{
+    return this->m_imag.data();
+}
+
+template<typename R>
+Complex SplitComplexPolynomial<R>::at(const Complex& t) const
+{
+    const R tr = static_cast<R>(t.re());
+    const R ti = static_cast<R>(t.im());
+
+    R vr = id_additive<R>::value, vi = id_additive<R>::value;
+    for (size_t i = this->m_real.size(); i-- > 0;)
+    {
+        const R r = vr * tr - vi * ti + this->m_real[i];
+        vi = vr * ti + vi * tr + this->m_imag[i];
+        vr = r;
+    }
+    POLYNOM_COUNT(multiplications, 4 * this->m_real.size());
+    POLYNOM_COUNT(additions, 4 * this->m_real.size());
+
+    return Complex(vr, vi);
+}
+
+template<typename R>
+void SplitComplexPolynomial<R>::evaluate(const std::vector<R>& pointsReal, const std::vector<R>& pointsImag,
+    std::vector<R>& valuesReal, std::vector<R>& valuesImag) const
+{
+    if (pointsReal.size() != pointsImag.size())
+        throw std::invalid_argument("The points need as many real parts as imaginary parts.");
+
+    POLYNOM_PHASE("evaluate");
+    const size_t count = pointsReal.size();
+    valuesReal.assign(count, id_additive<R>::value);
+    valuesImag.assign(count, id_additive<R>::value);
+
+    const R* zr = pointsReal.data();
+    const R* zi = pointsImag.data();
+    R* vr = valuesReal.data();
+    R* vi = valuesImag.data();
+    for (size_t i = this->m_real.size(); i-- > 0;)
+    {
+        const R cr = this->m_real[i];
+        const R ci = this->m_imag[i];
+        for (size_t k = 0; k < count; ++k)
+        {
+            const R r = vr[k] * zr[k] - vi[k] * zi[k] + cr;
+            vi[k] = vr[k] * zi[k] + vi[k] * zr[k] + ci;
+            vr[k] = r;
+        }
+    }
+    POLYNOM_COUNT(multiplications, 4 * this->m_real.size() * count);
+    POLYNOM_COUNT(additions, 4 * this->m_real.size() * count);
+}
+
+template<typename R>
+SplitComplexPolynomial<R> SplitComplexPolynomial<R>::derive() const
+{
+    SplitComplexPolynomial<R> derivative;
+    if (this->m_real.size() < 2)
+        return derivative;
+
+    derivative.m_real.assign(this->m_real.size() - 1, id_additive<R>::value);
+    derivative.m_imag.assign(this->m_imag.size() - 1, id_additive<R>::value);
+    for (size_t i = 1; i < this->m_real.size(); ++i)
+    {
+        derivative.m_real[i - 1] = static_cast<R>(i) * this->m_real[i];
+        derivative.m_imag[i - 1] = static_cast<R>(i) * this->m_imag[i];
+    }
+    POLYNOM_COUNT(multiplications, 2 * derivative.m_real.size());
+
+    derivative._trim();
+    return derivative;
+}
+
+template<typename R>
+void SplitComplexPolynomial<R>::add(const SplitComplexPolynomial<R>& poly)
+{
+    if (this->m_real.size() < poly.m_real.size())
+    {
+        this->m_real.resize(poly.m_real.size(), id_additive<R>::value);
+        this->m_imag.resize(poly.m_imag.size(), id_additive<R>::value);
+    }
+
+    simd_add(this->m_real.data(), poly.m_real.data(), this->m_real.data(), poly.m_real.size());
+    simd_add(this->m_imag.data(), poly.m_imag.data(), this->m_imag.data(), poly.m_imag.size());
+    this->_trim();
+}
+
+template<typename R>
+void SplitComplexPolynomial<R>::subtract(const SplitComplexPolynomial<R>& poly)
+{
+    if (this->m_real.size() < poly.m_real.size())
+    {
+        this->m_real.resize(poly.m_real.size(), id_additive<R>::value);
+        this->m_imag.resize(poly.m_imag.size(), id_additive<R>::value);
+    }
+
+    simd_subtract(this->m_real.data(), poly.m_real.data(), this->m_real.data(), poly.m_real.size());
+    simd_subtract(this->m_imag.data(), poly.m_imag.data(), this->m_imag.data(), poly.m_imag.size());
+    this->_trim();
+}
+
+template<typename R>
+void SplitComplexPolynomial<R>::multiply(const SplitComplexPolynomial<R>& poly)
+{
+    if (this->isNull() || poly.isNull())
+    {
+        this->m_real.clear();
+        this->m_imag.clear();
+        return;
+    }
+
+    POLYNOM_PHASE("multiply");
+    const size_t n = this->m_real.size(), m = poly.m_real.size();
+    CoefficientBuffer<R> real(n + m - 1, id_additive<R>::value), imag(n + m - 1, id_additive<R>::value);
+    CoefficientBuffer<R> imagProduct(n + m - 1, id_additive<R>::value);
+
+    // real = ar*br - ai*bi, imag = ar*bi + ai*br
+    dense_multiply_add(this->m_real.data(), n, poly.m_real.data(), m, real.data());
+    dense_multiply_add(this->m_imag.data(), n, poly.m_imag.data(), m, imagProduct.data());
+    simd_subtract(real.data(), imagProduct.data(), real.data(), real.size());
+    dense_multiply_add(this->m_real.data(), n, poly.m_imag.data(), m, imag.data());
+    dense_multiply_add(this->m_imag.data(), n, poly.m_real.data(), m, imag.data());
+
+    this->m_real.swap(real);
+    this->m_imag.swap(imag);
+    this->_trim();
+}
+
+template<typename R>
+SplitComplexPolynomial<R>::operator Polynomial<Complex>() const
+{
+    std::vector<Complex> coefficients(this->m_real.size());
+    for (size_t i = 0; i < coefficients.size(); ++i)
+        coefficients[i] = Complex(this->m_real[i], this->m_imag[i]);
+    return Polynomial<Complex>(coefficients.cbegin(), coefficients.cend());
+}
+
+template<typename R>
+void SplitComplexPolynomial<R>::_trim()
+{
+    size_t length = this->m_real.size();
+    while (length > 0 && this->m_real[length - 1] == id_additive<R>::value
+        && this->m_imag[length - 1] == id_additive<R>::value)
+        --length;
+
+    this->m_real.resize(length);
+    this->m_imag.resize(length);
+}
+
+/* Operators */
+template<typename R>
+SplitComplexPolynomial<R> operator + (const SplitComplexPolynomial<R>& a, const SplitComplexPolynomial<R>& b)
+{
+    SplitComplexPolynomial<R> result = a;
+    result.add(b);
+    return result;
+}
+
+template<typename R>
+SplitComplexPolynomial<R> operator - (const SplitComplexPolynomial<R>& a, const SplitComplexPolynomial<R>& b)
+{
+    SplitComplexPolynomial<R> result = a;
+    result.subtract(b);
+    return result;
+}
+
+template<typename R>
+SplitComplexPolynomial<R> operator * (const SplitComplexPolynomial<R>& a, const SplitComplexPolynomial<R>& b)
+{
+    SplitComplexPolynomial<R> result = a;
+    result.multiply(b);
+    return result;
+}
+
+template<typename R>
+bool operator == (const SplitComplexPolynomial<R>& a, const SplitComplexPolynomial<R>& b)
+{
+    return a.m_real == b.m_real && a.m_imag == b.m_imag;
+}
+
+template<typename R>
+bool operator != (const SplitComplexPolynomial<R>& a, const SplitComplexPolynomial<R>& b)
+{
+    return !(a == b);
+}
+
+#endif // _SPLIT_COMPLEX_POLYNOMIAL_H
@@ -0,0 +1,250 @@
+#ifndef _STATIC_POLYNOMIAL_H
+#define _STATIC_POLYNOMIAL_H
+
+#include <cstddef>
+#include "Polynomial.hpp"
+
+// Polynomials which are known at compile time, like the approximating polynomials of math functions.
+//
+// StaticPolynomial<T, N> has N + 1 coefficients, and everything it does is constexpr: the coefficient tables,
+// the derivatives, the products and the evaluations at known points are all folded by the compiler. Evaluating
+// at a point known only at runtime needs no setup either: the Horner and Estrin evaluators are generated for the
+// degree N, with no loops and no branches.
+//
+//     constexpr StaticPolynomial<double, 3> f(1.0, 1.0, 0.5, 1.0 / 6); // 1 + x + x^2/2 + x^3/6
+//     static_assert(f.at(2.0) > 6.0, "...");
+//     double y = f.estrin(x);
+//
+// T must be a literal type whose operators are constexpr (the arithmetic types are; the number classes of the
+// library are not). This needs C++11 constexpr only, so every function is a single expression: the loops are
+// template recursions. (The operations are not counted by the instrumentation.)
+
+// Compile-time sequence of indices, to expand the coefficients of a new polynomial in one expression
+template<size_t... I>
+struct _index_sequence
+{
+};
+
+template<size_t N, size_t... I>
+struct _make_index_sequence : _make_index_sequence<N - 1, N - 1, I...>
+{
+};
+
+template<size_t... I>
+struct _make_index_sequence<0, I...>
+{
+    typedef _index_sequence<I...> type;
+};
+
+// Horner's rule from the Ith coefficient up: c[I] + x * (c[I + 1] + x * (...))
+template<typename T, size_t N, size_t I>
+struct _static_horner
+{
+    static constexpr T at(const T (&coefficients)[N + 1], const T& x)
+    {
+        return coefficients[I] + x * _static_horner<T, N, I + 1>::at(coefficients, x);
+    }
+};
+
+template<typename T, size_t N>
+struct _static_horner<T, N, N>
+{
+    static constexpr T at(const T (&coefficients)[N + 1], const T&)
+    {
+        return coefficients[N];
+    }
+};
+
+// x^P for P a power of two, by squaring
+template<typename T, size_t P>
+struct _static_power
+{
+    static constexpr T square(const T& x)
+    {
+        return x * x;
+    }
+
+    static constexpr T of(const T& x)
+    {
+        return square(_static_power<T, P / 2>::of(x));
+    }
+};
+
+template<typename T>
+struct _static_power<T, 1>
+{
+    static constexpr T of(const T& x)
+    {
+        return x;
+    }
+};
+
+// The largest power of two below count (count > 1)
+constexpr size_t _estrin_split(const size_t count, const size_t half = 1)
+{
+    return (2 * half >= count ? half : _estrin_split(count, 2 * half));
+}
+
+// Estrin's scheme on the Count coefficients from c[Low] up: the lower split of them and the rest are evaluated
+// independently and combined as low + x^split * high. (The two halves don't wait for each other, so the processor
+// can calculate them at the same time, unlike the chain of Horner's rule.)
+template<typename T, size_t N, size_t Low, size_t Count>
+struct _static_estrin
+{
+    static const size_t split = _estrin_split(Count);
+
+    static constexpr T at(const T (&coefficients)[N + 1], const T& x)
+    {
+        return _static_estrin<T, N, Low, split>::at(coefficients, x)
+            + _static_power<T, split>::of(x) * _static_estrin<T, N, Low + split, Count - split>::at(coefficients, x);
+    }
+};
+
+template<typename T, size_t N, size_t Low>
+struct _static_estrin<T, N, Low, 1>
+{
+    static constexpr T at(const T (&coefficients)[N + 1], const T&)
+    {
+        return coefficients[Low];
+    }
+};
+
+template<typename T, size_t N>
+class StaticPolynomial
+{
+    public:
+        // The coefficients from x^0 up, exactly N + 1 of them (converted to T)
+        template<typename... C>
+        constexpr StaticPolynomial(const C... coefficients)
+            : m_coefficients{ static_cast<T>(coefficients)... }
+        {
+            static_assert(sizeof...(C) == N + 1, "A StaticPolynomial<T, N> needs N + 1 coefficients.");
+        }
+
+        // The degree it was declared with (the leading coefficient can still be zero)
+        constexpr size_t degree() const
+        {
+            return N;
+        }
+
+        // Get the nth coefficient (zero above the degree)
+        constexpr T getMember(const size_t index) const
+        {
+            return (index <= N ? this->m_coefficients[index] : static_cast<T>(0));
+        }
+
+        constexpr T operator [] (const size_t index) const
+        {
+            return this->getMember(index);
+        }
+
+        // The value at t, with Horner's rule (the same operations as Polynomial<T>::at())
+        constexpr T at(const T& t) const
+        {
+            return _static_horner<T, N, 0>::at(this->m_coefficients, t);
+        }
+
+        // The value at t, with Estrin's scheme: the same number of multiplications and a few squarings, but a
+        // shorter dependency chain (about log2(N) multiplications long instead of N), which is faster for the
+        // higher degrees. The result is rounded differently from Horner's rule.
+        constexpr T estrin(const T& t) const
+        {
+            return _static_estrin<T, N, 0, N + 1>::at(this->m_coefficients, t);
+        }
+
+        // Algebraic derivative (a constant's is the zero constant)
+        constexpr StaticPolynomial<T, (N > 0 ? N - 1 : 0)> derive() const
+        {
+            return this->_derive(typename _make_index_sequence<(N > 0 ? N : 1)>::type());
+        }
+
+        // The polynomial with every coefficient multiplied by c
+        constexpr StaticPolynomial<T, N> scale(const T& c) const
+        {
+            return this->_scale(c, typename _make_index_sequence<N + 1>::type());
+        }
+
+        // The product with a degree M polynomial
+        template<size_t M>
+        constexpr StaticPolynomial<T, N + M> multiply(const StaticPolynomial<T, M>& other) const
+        {
+            return this->_multiply(other, typename _make_index_sequence<N + M + 1>::type());
+        }
+
+        // Conversion to a (runtime) Polynomial<T>
+        operator Polynomial<T>() const
+        {
+            return Polynomial<T>(this->m_coefficients, this->m_coefficients + N + 1);
+        }
+
+    private:
+        // The ith element is the coefficient of x^i
+        T m_coefficients[N + 1];
+
+        // The derivative's coefficient of x^index: (index + 1) * c[index + 1]
+        constexpr T _derivative(const size_t index) const
+        {
+            return static_cast<T>(index + 1) * this->getMember(index + 1);
+        }
+
+        template<size_t... I>
+        constexpr StaticPolynomial<T, (N > 0 ? N - 1 : 0)> _derive(_index_sequence<I...>) const
+        {
+            return StaticPolynomial<T, (N > 0 ? N - 1 : 0)>(this->_derivative(I)...);
+        }
+
+        template<size_t... I>
+        constexpr StaticPolynomial<T, N> _scale(const T& c, _index_sequence<I...>) const
+        {
+            return StaticPolynomial<T, N>(this->m_coefficients[I] * c...);
+        }
+
+        // The product's coefficient of x^index, summed from the ith coefficient of this polynomial up
+        template<size_t M>
+        constexpr T _product(const StaticPolynomial<T, M>& other, const size_t index, const size_t i) const
+        {
+            return (i > index || i > N ? static_cast<T>(0)
+                : this->m_coefficients[i] * other.getMember(index - i) + this->_product(other, index, i + 1));
+        }
+
+        template<size_t M, size_t... I>
+        constexpr StaticPolynomial<T, N + M> _multiply(const StaticPolynomial<T, M>& other, _index_sequence<I...>) const
+        {
+            return StaticPolynomial<T, N + M>(this->_product(other, I, 0)...);
+        }
+};
+
+// Sum and difference (of the same degree), product
+template<typename T, size_t N, size_t... I>
+constexpr StaticPolynomial<T, N> _static_sum(const StaticPolynomial<T, N>& a, const StaticPolynomial<T, N>& b,
+    _index_sequence<I...>)
+{
+    return StaticPolynomial<T, N>((a[I] + b[I])...);
+}
+
+template<typename T, size_t N, size_t... I>
+constexpr StaticPolynomial<T, N> _static_difference(const StaticPolynomial<T, N>& a, const StaticPolynomial<T, N>& b,
+    _index_sequence<I...>)
+{
+    return StaticPolynomial<T, N>((a[I] - b[I])...);
+}
+
+template<typename T, size_t N>
+constexpr StaticPolynomial<T, N> operator + (const StaticPolynomial<T, N>& a, const StaticPolynomial<T, N>& b)
+{
+    return _static_sum(a, b, typename _make_index_sequence<N + 1>::type());
+}
+
+template<typename T, size_t N>
+constexpr StaticPolynomial<T, N> operator - (const StaticPolynomial<T, N>& a, const StaticPolynomial<T, N>& b)
+{
+    return _static_difference(a, b, typename _make_index_sequence<N + 1>::type());
+}
+
+template<typename T, size_t N, size_t M>
+constexpr StaticPolynomial<T, N + M> operator * (const StaticPolynomial<T, N>& a, const StaticPolynomial<T, M>& b)
+{
+    return a.multiply(b);
+}
+
+#endif // _STATIC_POLYNOMIAL_H
@@ -0,0 +1,348 @@
+#ifndef _THREAD_POOL_H
+#define _THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A fixed-size pool of worker threads which execute the tasks submitted to it.
+// The algorithms of the library which can run in parallel take a pool as an argument,
+// so the same workers are reused instead of spawning new threads for every call.
+//
+// Every worker has its own queue of tasks. Tasks submitted by a worker (like the helpers of a parallel_for()
+// inside a task) go to its own queue, from which it takes the newest one first, while idle workers steal the
+// oldest tasks of the others. So nested parallel work spreads over the pool without every thread fighting
+// for a single queue. Tasks submitted from outside are dealt out to the queues in turn.
+class ThreadPool
+{
+    public:
+        // Create the pool with the given number of workers (at least one is always created)
+        ThreadPool(size_t threads);
+
+        // Destruction finishes the already submitted tasks and joins the workers
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        // Get the number of worker threads
+        size_t size() const;
+
+        // Submit a task, the returned future can be used to wait for (and get) its result
+        template<typename F>
+        std::future<typename std::result_of<F()>::type> submit(F task);
+
+        // Execute body(i) for every i in [begin, end) and wait until all of them are done.
+        // The calling thread also takes its part of the work. A worker of the pool runs other queued tasks while
+        // it waits for the rest, so this may be called from inside a task too (the nested loops keep every worker
+        // busy); any other thread only runs the body, then sleeps until the helpers are done.
+        template<typename F>
+        void parallel_for(size_t begin, size_t end, F body);
+
+        // A pool shared by the whole program, with as many workers as the hardware has threads
+        // (unless set otherwise by setSharedSize())
+        static ThreadPool& shared();
+
+        // Set the number of workers of the shared pool (0 means as many as the hardware has threads).
+        // This only has an effect before the shared pool is first used: returns whether it had.
+        static bool setSharedSize(const size_t threads);
+
+    private:
+        // The tasks of a worker: it takes them from the back, the others steal from the front
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::thread> m_workers;
+        std::vector<std::unique_ptr<Queue>> m_queues;
+
+        // The number of tasks in the queues, and the queue of the next task submitted from outside
+        // (both under the lock of the condition)
+        size_t m_pending;
+        size_t m_next;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopping;
+
+        // Queue a task: to the calling worker's own queue, or to the next one if called from outside
+        void _push(std::function<void()> task);
+
+        // Take the newest task of the worker's own queue, or steal the oldest one of another
+        bool _pop(const size_t index, std::function<void()>& task);
+
+        void _work(const size_t index);
+
+        // The pool and the index of the worker running on the calling thread (nullptr if none)
+        static ThreadPool*& _currentPool();
+        static size_t& _currentIndex();
+
+        static std::mutex& _sharedMutex();
+        static size_t& _sharedSize();
+        static bool& _sharedCreated();
+};
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    this->m_stopping = false;
+    this->m_pending = 0;
+    this->m_next = 0;
+
+    if (threads == 0)
+        threads = 1;
+
+    // Every queue exists before any worker could steal from it
+    for (size_t i = 0; i < threads; ++i)
+        this->m_queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    for (size_t i = 0; i < threads; ++i)
+        this->m_workers.push_back(std::thread(&ThreadPool::_work, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_stopping = true;
+    }
+    this->m_condition.notify_all();
+
+    for (std::vector<std::thread>::iterator it = this->m_workers.begin(); it != this->m_workers.end(); ++it)
+        it->join();
+}
+
+size_t ThreadPool::size() const
+{
+    return this->m_workers.size();
+}
+
+template<typename F>
+std::future<typename std::result_of<F()>::type> ThreadPool::submit(F task)
+{
+    typedef typename std::result_of<F()>::type result_type;
+
+    // std::function needs a copyable callable, so the packaged task is kept behind a shared pointer
+    std::shared_ptr<std::packaged_task<result_type()>> packaged =
+        std::make_shared<std::packaged_task<result_type()>>(task);
+    std::future<result_type> result = packaged->get_future();
+
+    this->_push([packaged]() { (*packaged)(); });
+    return result;
+}
+
+template<typename F>
+void ThreadPool::parallel_for(size_t begin, size_t end, F body)
+{
+    if (begin >= end)
+        return;
+
+    // The indices are handed out one by one from a shared counter, so faster threads simply take more of them.
+    // Helpers which only get to run after every index was taken return without touching the body,
+    // that's why the caller only has to wait for the helpers which actually started working.
+    struct State
+    {
+        std::atomic<size_t> next;
+        std::atomic<size_t> working;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+    state->next = begin;
+    state->working = 0;
+
+    std::function<void()> helper = [state, end, &body]()
+    {
+        // Register as a worker before taking any index, so the caller can't miss us
+        ++state->working;
+        try
+        {
+            for (size_t i = state->next++; i < end; i = state->next++)
+                body(i);
+        }
+        catch (...)
+        {
+            // Stop handing out the remaining indices and report the first error to the caller
+            state->next = end;
+            std::unique_lock<std::mutex> lock(state->mutex);
+            if (!state->error)
+                state->error = std::current_exception();
+        }
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        --state->working;
+        state->done.notify_all();
+    };
+
+    size_t helpers = std::min(this->size(), end - begin - 1);
+    for (size_t i = 0; i < helpers; ++i)
+        this->_push(helper);
+
+    helper();
+
+    // Outside the pool the queued tasks belong to others: they must not run with the thread local state of the
+    // caller (its arena, its counters), nor keep it waiting, so it just sleeps until the helpers are done
+    if (ThreadPool::_currentPool() != this)
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state]() { return state->working.load() == 0; });
+        if (state->error)
+            std::rethrow_exception(state->error);
+        return;
+    }
+
+    // While the helpers which started are still working, a worker runs the queued tasks instead of sleeping (the
+    // helpers of the nested parallel_for() calls of our helpers among them), so it isn't lost for the pool
+    const size_t index = ThreadPool::_currentIndex();
+    while (state->working.load() != 0)
+    {
+        std::function<void()> task;
+        if (this->_pop(index, task))
+        {
+            task();
+            continue;
+        }
+
+        // Nothing to run: sleep until the helpers are done, looking for new tasks from time to time
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait_for(lock, std::chrono::microseconds(100), [&state]() { return state->working.load() == 0; });
+    }
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    // The size can't change once the pool is (about to be) created
+    {
+        std::unique_lock<std::mutex> lock(ThreadPool::_sharedMutex());
+        ThreadPool::_sharedCreated() = true;
+    }
+
+    static ThreadPool pool(ThreadPool::_sharedSize() != 0 ? ThreadPool::_sharedSize() : std::thread::hardware_concurrency());
+    return pool;
+}
+
+bool ThreadPool::setSharedSize(const size_t threads)
+{
+    std::unique_lock<std::mutex> lock(ThreadPool::_sharedMutex());
+    if (ThreadPool::_sharedCreated())
+        return false;
+
+    ThreadPool::_sharedSize() = threads;
+    return true;
+}
+
+void ThreadPool::_push(std::function<void()> task)
+{
+    // Count the task before it's queued, so a worker which sees it counted will find it (after a short wait)
+    size_t index;
+    {
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        index = (ThreadPool::_currentPool() == this ? ThreadPool::_currentIndex() : this->m_next++ % this->m_queues.size());
+        ++this->m_pending;
+    }
+    {
+        std::unique_lock<std::mutex> lock(this->m_queues[index]->mutex);
+        this->m_queues[index]->tasks.push_back(std::move(task));
+    }
+    this->m_condition.notify_one();
+}
+
+bool ThreadPool::_pop(const size_t index, std::function<void()>& task)
+{
+    for (size_t i = 0; i < this->m_queues.size(); ++i)
+    {
+        Queue& queue = *this->m_queues[(index + i) % this->m_queues.size()];
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+
+            if (i == 0)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        --this->m_pending;
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::_work(const size_t index)
+{
+    ThreadPool::_currentPool() = this;
+    ThreadPool::_currentIndex() = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (this->_pop(index, task))
+        {
+            task();
+            continue;
+        }
+
+        // Sleep until there is a task somewhere, or the pool is destructed with every task done
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+        this->m_condition.wait(lock, [this]() { return this->m_stopping || this->m_pending != 0; });
+
+        if (this->m_stopping && this->m_pending == 0)
+            return;
+    }
+}
+
+ThreadPool*& ThreadPool::_currentPool()
+{
+    static thread_local ThreadPool* pool = nullptr;
+    return pool;
+}
+
+size_t& ThreadPool::_currentIndex()
+{
+    static thread_local size_t index = 0;
+    return index;
+}
+
+std::mutex& ThreadPool::_sharedMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+size_t& ThreadPool::_sharedSize()
+{
+    static size_t size = 0;
+    return size;
+}
+
+bool& ThreadPool::_sharedCreated()
+{
+    static bool created = false;
+    return created;
+}
+
+#endif // _THREAD_POOL_H
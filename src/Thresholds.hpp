@@ -0,0 +1,63 @@
+#ifndef _THRESHOLDS_H
+#define _THRESHOLDS_H
+
+#include <cstddef>
+
+// The crossover lengths between the algorithms of the library. The defaults are educated guesses; the right
+// values depend on the coefficient type and the machine, so they can be measured with the tuning program
+// (benchmark/tune.cpp), which writes them into a header of algorithm_thresholds<T> specialisations.
+// That header is used if POLYNOM_TUNED_THRESHOLDS is defined: it must be on the include path as
+// TunedThresholds.hpp (the CMake option of the same name does all this).
+
+// Below this length (of the shorter operand) the schoolbook method is faster than Karatsuba's
+const size_t KARATSUBA_THRESHOLD = 32;
+
+// Above this length the quotient is calculated with a power series inverse instead of the long division
+const size_t NEWTON_DIVISION_THRESHOLD = 64;
+
+// Above this length the half-gcd algorithm is used instead of Euclid's
+// (Without a multiplication faster than Karatsuba's, half-gcd only pays off for long polynomials: measured
+// with ResidueNum coefficients, Euclid's algorithm is still about 1.4 times as fast at degree 1000.)
+const size_t HALF_GCD_THRESHOLD = 2048;
+
+// Below this length the half-gcd algorithm does the Euclidean steps instead of recursing
+const size_t HALF_GCD_RECURSION_THRESHOLD = 128;
+
+// Polynomial::divide() does the long division on dense buffers instead of the map of the members if at least
+// every this many-th member of the divisor is non-zero. (Sparse divisors, like x^n - 1, are faster to subtract
+// member by member.)
+const size_t DENSE_DIVISION_THRESHOLD = 16;
+
+// The parallel multiplication splits the work into tasks until the operands are shorter than this
+const size_t PARALLEL_MULTIPLICATION_THRESHOLD = 2048;
+
+// The thresholds for a coefficient type (the values must only be used by value, they are not defined out of class)
+struct default_algorithm_thresholds
+{
+    static const size_t karatsuba = KARATSUBA_THRESHOLD;
+    static const size_t newtonDivision = NEWTON_DIVISION_THRESHOLD;
+    static const size_t halfGcd = HALF_GCD_THRESHOLD;
+    static const size_t halfGcdRecursion = HALF_GCD_RECURSION_THRESHOLD;
+    static const size_t denseDivision = DENSE_DIVISION_THRESHOLD;
+    static const size_t parallelMultiplication = PARALLEL_MULTIPLICATION_THRESHOLD;
+};
+
+template<typename T>
+struct algorithm_thresholds : default_algorithm_thresholds
+{
+};
+
+// Access to the internals for the tuning program (only defined there)
+template<typename T>
+struct threshold_tuning;
+
+#ifdef POLYNOM_TUNED_THRESHOLDS
+// The coefficient types the tuned header may specialise the thresholds for
+class Rational;
+class Complex;
+template<long M> class ResidueNum;
+
+#include "TunedThresholds.hpp"
+#endif // POLYNOM_TUNED_THRESHOLDS
+
+#endif // _THRESHOLDS_H
@@ -39,6 +39,10 @@ struct id_multiplicative_integral
 	static const _T value = 1;
 };
 
+// The value is bound to references (e.g. when filling containers with it), so it needs a definition too.
+template<typename _T>
+const _T id_multiplicative_integral<_T>::value;
+
 
 // Specialise the template, because we know the multiplicative inverse for arithmetic types
 // Existance
@@ -112,6 +116,9 @@ struct id_additive_integral
     static const _T value = 0;
 };
 
+template<typename _T>
+const _T id_additive_integral<_T>::value;
+
 template<> struct id_additive_exists<char> : id_additive_known{};
 template<> struct id_additive_exists<unsigned char> : id_additive_known{};
 template<> struct id_additive_exists<signed char> : id_additive_known{};
@@ -1,5 +1,6 @@
 /*
 * This must be built against the C++11 standard!
+* (And linked against the threading library, e.g. with -pthread.)
 */
 #include <string>
 #include <iostream>
@@ -609,6 +610,10 @@ int main4()
     // Vatai dimat2 2. mintazh megoldsa
     // f(1) = 2, f(2) = 3, f(3) = 5, f(4) = 7 in Z_13[x]
     Lagrange<ResidueNum<13>> lag;
+    lag.trace([](const ResidueNum<13>& Ci, const Polynomial<ResidueNum<13>>& li)
+    {
+        cout << "l" << Ci << " = " << li << endl << endl;
+    });
     lag.add(ResidueNum<13>(1), ResidueNum<13>(2));
     lag.add(ResidueNum<13>(2), ResidueNum<13>(3));
     lag.add(ResidueNum<13>(3), ResidueNum<13>(5));
@@ -626,6 +631,10 @@ int main4()
     // Nagy Gbor diasor.
     cout << endl << endl;
     Lagrange<Rational> l2;
+    l2.trace([](const Rational& Ci, const Polynomial<Rational>& li)
+    {
+        cout << "l" << Ci << " = " << li << endl << endl;
+    });
     l2.add(Rational(0), Rational(3));
     l2.add(Rational(1), Rational(3));
     l2.add(Rational(4), Rational(7));